@@ -0,0 +1,218 @@
+//-----------------------------------------------------------------------------
+// File        : bench_disrupt.cpp
+// Description : Microbenchmark of the disrupt() set kernel
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012, Russell J. Funk and Jason Owen Smith
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the University of Michigan nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL RUSSELL J. FUNK OR JASON OWEN-SMITH BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+// Author    : Russell J. Funk
+// Email     : funk@umich.edu
+// Web page  : http://www-personal.umich.edu/~funk/index.html
+// Location  : University of Michigan, Ann Arbor, Michigan
+// Date      : December 15, 2012
+// Reference : http://arxiv.org/abs/1212.3559 (pp. 6-8 and pp. 24-25)
+//-----------------------------------------------------------------------------
+
+// to compile and use
+
+// g++ -std=c++11 -O2 -pthread -I../src bench_disrupt.cpp
+//     $(ls ../src/*.cpp | grep -v main.cpp) -o bench_disrupt
+
+// ./bench_disrupt vertices.csv edges.csv [endtime] [repetitions]
+
+// times the marker-based kernel behind EDGraph::metrics() against the
+// sort/unique/binary_search kernel that disrupt() used before, over every
+// vertex of the graph at one end time, and checks that they agree
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "edgraph_v1.h"
+
+// plain copy of the graph in compressed sparse row form, built through the
+// public interface, for the reference kernel
+struct Reference {
+    std::vector<unsigned long> ids;
+    std::vector<unsigned long> times;
+    std::vector<unsigned long> citedoffsets;
+    std::vector<unsigned long> cited;
+    std::vector<unsigned long> citingoffsets;
+    std::vector<unsigned long> citing;
+    std::vector<unsigned long> citingtimes;
+    
+    // end of the citations to vertex i made at or before endtime, which
+    // citing() returns in time order
+    unsigned long citingend(unsigned long i, unsigned long endtime) const {
+        return std::upper_bound(citingtimes.begin() + citingoffsets[i],
+                                citingtimes.begin() + citingoffsets[i + 1],
+                                endtime) - citingtimes.begin();
+    }
+    
+    unsigned long index(unsigned long vertex) const {
+        return std::lower_bound(ids.begin(), ids.end(), vertex) - ids.begin();
+    }
+};
+
+// build the reference copy of g
+static void reference(const EDGraph &g, Reference &r) {
+    
+    std::vector<unsigned long> vertices = g.vertices();
+    std::vector<unsigned long> buffer;
+    
+    r.ids = vertices;
+    for (unsigned long k = 0; k < vertices.size(); k++) {
+        g.cited(vertices[k], buffer);
+        r.ids.insert(r.ids.end(), buffer.begin(), buffer.end());
+    }
+    std::sort(r.ids.begin(), r.ids.end());
+    r.ids.erase(std::unique(r.ids.begin(), r.ids.end()), r.ids.end());
+    
+    r.citedoffsets.push_back(0);
+    r.citingoffsets.push_back(0);
+    for (unsigned long k = 0; k < r.ids.size(); k++) {
+        r.times.push_back(g.time(r.ids[k]));
+        g.cited(r.ids[k], buffer);
+        for (unsigned long e = 0; e < buffer.size(); e++) {
+            r.cited.push_back(r.index(buffer[e]));
+        }
+        r.citedoffsets.push_back(r.cited.size());
+        g.citing(r.ids[k], EDGraph::notime - 1, buffer);
+        for (unsigned long e = 0; e < buffer.size(); e++) {
+            r.citing.push_back(r.index(buffer[e]));
+            r.citingtimes.push_back(g.time(buffer[e]));
+        }
+        r.citingoffsets.push_back(r.citing.size());
+    }
+}
+
+// the previous kernel: take f_i and the b_i from the time-sorted citation
+// lists, sort and unique b_i, merge it with f_i into i with another sort and
+// unique, and classify every element of i with two binary searches; returns
+// the raw disruptiveness and n_i
+static void sortkernel(const Reference &r, unsigned long focal,
+                       unsigned long endtime, long &d_raw, unsigned long &n_i) {
+    
+    std::vector<unsigned long> f_i(r.citing.begin() + r.citingoffsets[focal],
+                                   r.citing.begin() + r.citingend(focal, endtime));
+    
+    std::vector<unsigned long> b_i;
+    for (unsigned long e1 = r.citedoffsets[focal]; e1 < r.citedoffsets[focal + 1]; e1++) {
+        unsigned long b = r.cited[e1];
+        b_i.insert(b_i.end(), r.citing.begin() + r.citingoffsets[b],
+                   r.citing.begin() + r.citingend(b, endtime));
+    }
+    std::sort(b_i.begin(), b_i.end());
+    b_i.erase(std::unique(b_i.begin(), b_i.end()), b_i.end());
+    
+    std::vector<unsigned long> i(f_i);
+    i.insert(i.end(), b_i.begin(), b_i.end());
+    std::sort(i.begin(), i.end());
+    i.erase(std::unique(i.begin(), i.end()), i.end());
+    
+    std::sort(f_i.begin(), f_i.end());
+    
+    d_raw = 0;
+    n_i = 0;
+    unsigned long focaltime = r.times[focal];
+    for (unsigned long k = 0; k < i.size(); k++) {
+        if (r.times[i[k]] > focaltime) {
+            n_i++;
+            bool f = std::binary_search(f_i.begin(), f_i.end(), i[k]);
+            bool b = std::binary_search(b_i.begin(), b_i.end(), i[k]);
+            d_raw += (f && b) ? -1 : (f ? 1 : 0);
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    
+    if (argc < 3) {
+        std::cout << "usage: " << argv[0];
+        std::cout << " [vertexfile] [edgefile] [endtime] [repetitions]" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    unsigned long endtime = argc > 3 ? strtoul(argv[3], NULL, 10) : 2010;
+    int repetitions = argc > 4 ? atoi(argv[4]) : 3;
+    
+    EDGraph g(argv[1], argv[2]);
+    Reference r;
+    reference(g, r);
+    
+    std::vector<unsigned long> vertices = g.vertices();
+    std::vector<unsigned long> focal(vertices.size());
+    for (unsigned long k = 0; k < vertices.size(); k++) {
+        focal[k] = r.index(vertices[k]);
+    }
+    
+    // check that both kernels agree on every vertex
+    Workspace workspace;
+    unsigned long mismatches = 0;
+    for (unsigned long k = 0; k < vertices.size(); k++) {
+        long d_raw;
+        unsigned long n_i;
+        sortkernel(r, focal[k], endtime, d_raw, n_i);
+        Metrics m = g.metrics(vertices[k], endtime, workspace);
+        if (n_i != m.n_i || d_raw != (long)m.fonly - (long)m.both) {
+            mismatches++;
+        }
+    }
+    
+    // best of a few runs of each kernel over all vertices
+    double sortbest = 1e300;
+    double markbest = 1e300;
+    unsigned long checksum = 0;
+    
+    for (int rep = 0; rep < repetitions; rep++) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (unsigned long k = 0; k < vertices.size(); k++) {
+            long d_raw;
+            unsigned long n_i;
+            sortkernel(r, focal[k], endtime, d_raw, n_i);
+            checksum += n_i;
+        }
+        std::chrono::steady_clock::time_point middle = std::chrono::steady_clock::now();
+        for (unsigned long k = 0; k < vertices.size(); k++) {
+            checksum += g.metrics(vertices[k], endtime, workspace).n_i;
+        }
+        std::chrono::steady_clock::time_point stop = std::chrono::steady_clock::now();
+        
+        sortbest = std::min(sortbest, std::chrono::duration<double>(middle - start).count());
+        markbest = std::min(markbest, std::chrono::duration<double>(stop - middle).count());
+    }
+    
+    std::cout << "vertices: " << vertices.size() << ", edges: " << r.cited.size();
+    std::cout << ", end time: " << endtime << ", mismatches: " << mismatches << std::endl;
+    std::cout << "sort kernel: " << 1e9*sortbest/vertices.size() << " ns/query" << std::endl;
+    std::cout << "mark kernel: " << 1e9*markbest/vertices.size() << " ns/query" << std::endl;
+    std::cout << "speedup: " << sortbest/markbest << "x (checksum " << checksum << ")" << std::endl;
+    
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,348 @@
+//-----------------------------------------------------------------------------
+// File        : bench_suite.cpp
+// Description : Benchmarks of the library on synthetic graphs of several sizes
+//-----------------------------------------------------------------------------
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the University of Michigan nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL RUSSELL J. FUNK OR JASON OWEN-SMITH BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+// Author    : Russell J. Funk
+// Email     : funk@umich.edu
+// Web page  : http://www-personal.umich.edu/~funk/index.html
+// Location  : University of Michigan, Ann Arbor, Michigan
+// Date      : December 15, 2012
+// Reference : http://arxiv.org/abs/1212.3559 (pp. 6-8 and pp. 24-25)
+//-----------------------------------------------------------------------------
+
+// to compile and use
+
+// g++ -std=c++11 -O2 -pthread -I../src bench_suite.cpp
+//     $(ls ../src/*.cpp | grep -v main.cpp) -o bench_suite
+
+// ./bench_suite [--scales n1,n2,...] [--years first last] [--outdegree m]
+//     [--skew s] [--seed k] [--threads t] [--repetitions r]
+//     [--cache megabytes] [--cache-threshold c] [--directory dir]
+//     [--output results.json]
+
+// for each number of vertices, generates a synthetic citation graph (see
+// citationgraph.h), writes it as csv files to dir and times reading them,
+// cited(), citing(), indegree() and disrupt() over every vertex at the last
+// year, disrupt() again with a cache of the citers of predecessors with at
+// least c citations (unless megabytes is 0), and the panel over all years
+// with either engine; cited(), citing(), disrupt() and the series panel are
+// then timed again with the adjacency lists compressed, along with the
+// memory they take either way. every time is the best of r runs. the
+// results are written as JSON, to the screen or to a file, so that runs of
+// different versions can be compared
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "citationgraph.h"
+#include "edgraph_v1.h"
+#include "panel.h"
+#include "results.h"
+
+// seconds since start
+static double since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// time the panel over all years with one engine, discarding the rows
+static double panel(const EDGraph &g, const std::vector<unsigned long> &vertices,
+                    const CitationGraphParameters &parameters, unsigned int threads,
+                    Panel::Engine engine) {
+    
+    std::ostream discard(NULL);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    ResultsSink sink(discard);
+    Panel panel(g, vertices, parameters.firstyear, parameters.lastyear, threads, engine);
+    panel.write(sink);
+    sink.close();
+    return since(start);
+}
+
+int main(int argc, char* argv[]) {
+    
+    CitationGraphParameters parameters;
+    std::vector<unsigned long> scales;
+    unsigned int threads = 0;
+    int repetitions = 3;
+    unsigned long cachebytes = 64UL << 20;
+    unsigned long threshold = 1024;
+    std::string directory = ".";
+    std::string outputfile;
+    
+    for (int k = 1; k < argc; k++) {
+        std::string arg = argv[k];
+        if (arg == "--scales" && k + 1 < argc) {
+            std::istringstream in(argv[++k]);
+            std::string scale;
+            while (std::getline(in, scale, ',')) {
+                scales.push_back(strtoul(scale.c_str(), NULL, 10));
+            }
+        }
+        else if (arg == "--years" && k + 2 < argc) {
+            parameters.firstyear = strtoul(argv[++k], NULL, 10);
+            parameters.lastyear = strtoul(argv[++k], NULL, 10);
+        }
+        else if (arg == "--outdegree" && k + 1 < argc) {
+            parameters.outdegree = strtoul(argv[++k], NULL, 10);
+        }
+        else if (arg == "--skew" && k + 1 < argc) {
+            parameters.skew = atof(argv[++k]);
+        }
+        else if (arg == "--seed" && k + 1 < argc) {
+            parameters.seed = strtoul(argv[++k], NULL, 10);
+        }
+        else if (arg == "--threads" && k + 1 < argc) {
+            threads = atoi(argv[++k]);
+        }
+        else if (arg == "--repetitions" && k + 1 < argc) {
+            repetitions = std::max(1, atoi(argv[++k]));
+        }
+        else if (arg == "--cache" && k + 1 < argc) {
+            cachebytes = strtoul(argv[++k], NULL, 10) << 20;
+        }
+        else if (arg == "--cache-threshold" && k + 1 < argc) {
+            threshold = strtoul(argv[++k], NULL, 10);
+        }
+        else if (arg == "--directory" && k + 1 < argc) {
+            directory = argv[++k];
+        }
+        else if (arg == "--output" && k + 1 < argc) {
+            outputfile = argv[++k];
+        }
+        else {
+            std::cout << "usage: " << argv[0];
+            std::cout << " [--scales n1,n2,...] [--years first last] [--outdegree m] [--skew s] [--seed k] [--threads t] [--repetitions r] [--cache megabytes] [--cache-threshold c] [--directory dir] [--output resultsfile]" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (scales.empty()) {
+        scales.push_back(10000);
+        scales.push_back(100000);
+        scales.push_back(1000000);
+    }
+    
+    std::ostringstream json;
+    json << "{\n";
+    json << "  \"benchmark\": \"bench_suite\",\n";
+    json << "  \"parameters\": {\"firstyear\": " << parameters.firstyear;
+    json << ", \"lastyear\": " << parameters.lastyear;
+    json << ", \"outdegree\": " << parameters.outdegree;
+    json << ", \"skew\": " << parameters.skew;
+    json << ", \"seed\": " << parameters.seed;
+    json << ", \"threads\": " << threads;
+    json << ", \"repetitions\": " << repetitions;
+    json << ", \"cache_bytes\": " << cachebytes;
+    json << ", \"cache_threshold\": " << threshold << "},\n";
+    json << "  \"scales\": [";
+    
+    for (unsigned long s = 0; s < scales.size(); s++) {
+        
+        parameters.vertices = scales[s];
+        std::ostringstream name;
+        name << directory << "/bench_" << scales[s];
+        std::string vertexfile = name.str() + "_vertices.csv";
+        std::string edgefile = name.str() + "_edges.csv";
+        
+        CitationGraph graph;
+        generate(parameters, graph);
+        if (!write(graph, vertexfile, edgefile)) {
+            std::cout << "could not write the files '" << vertexfile << "' and '" << edgefile << "'" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        std::cerr << "scale " << scales[s] << ": " << graph.vertices.size();
+        std::cerr << " vertices, " << graph.edges.size() << " edges" << std::endl;
+        
+        double load = 1e300;
+        double cited = 1e300;
+        double citing = 1e300;
+        double indegree = 1e300;
+        double disrupt = 1e300;
+        double cached = 1e300;
+        CiterCacheStats cachestats = CiterCacheStats();
+        double series = 1e300;
+        double sweep = 1e300;
+        double compress = 1e300;
+        double packedcited = 1e300;
+        double packedciting = 1e300;
+        double packeddisrupt = 1e300;
+        double packedseries = 1e300;
+        unsigned long bytes = 0;
+        unsigned long packedbytes = 0;
+        unsigned long checksum = 0;
+        double sum = 0;
+        double cachedsum = 0;
+        double packedsum = 0;
+        
+        for (int rep = 0; rep < repetitions; rep++) {
+            
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            EDGraph g(vertexfile, edgefile, threads);
+            load = std::min(load, since(start));
+            
+            std::vector<unsigned long> vertices = g.vertices();
+            std::vector<unsigned long> buffer;
+            
+            start = std::chrono::steady_clock::now();
+            for (unsigned long k = 0; k < vertices.size(); k++) {
+                g.cited(vertices[k], buffer);
+                checksum += buffer.size();
+            }
+            cited = std::min(cited, since(start));
+            
+            start = std::chrono::steady_clock::now();
+            for (unsigned long k = 0; k < vertices.size(); k++) {
+                g.citing(vertices[k], parameters.lastyear, buffer);
+                checksum += buffer.size();
+            }
+            citing = std::min(citing, since(start));
+            
+            start = std::chrono::steady_clock::now();
+            for (unsigned long k = 0; k < vertices.size(); k++) {
+                checksum += g.indegree(vertices[k], parameters.lastyear);
+            }
+            indegree = std::min(indegree, since(start));
+            
+            Workspace workspace;
+            start = std::chrono::steady_clock::now();
+            for (unsigned long k = 0; k < vertices.size(); k++) {
+                double d = g.disrupt(vertices[k], parameters.lastyear, workspace);
+                if (d == d) {
+                    sum += d;
+                }
+            }
+            disrupt = std::min(disrupt, since(start));
+            
+            // a fresh cache each time, so that its misses are timed too
+            if (cachebytes > 0) {
+                EDGraph::CiterCache cache(cachebytes, threshold);
+                g.cache(&cache);
+                start = std::chrono::steady_clock::now();
+                for (unsigned long k = 0; k < vertices.size(); k++) {
+                    double d = g.disrupt(vertices[k], parameters.lastyear, workspace);
+                    if (d == d) {
+                        cachedsum += d;
+                    }
+                }
+                cached = std::min(cached, since(start));
+                cachestats = cache.stats();
+                g.cache(NULL);
+            }
+            
+            series = std::min(series, panel(g, vertices, parameters, threads, Panel::SERIES));
+            sweep = std::min(sweep, panel(g, vertices, parameters, threads, Panel::SWEEP));
+            
+            // the same on the compressed lists, which is for good
+            bytes = g.adjacencybytes();
+            start = std::chrono::steady_clock::now();
+            g.compress();
+            compress = std::min(compress, since(start));
+            packedbytes = g.adjacencybytes();
+            
+            start = std::chrono::steady_clock::now();
+            for (unsigned long k = 0; k < vertices.size(); k++) {
+                g.cited(vertices[k], buffer);
+                checksum += buffer.size();
+            }
+            packedcited = std::min(packedcited, since(start));
+            
+            start = std::chrono::steady_clock::now();
+            for (unsigned long k = 0; k < vertices.size(); k++) {
+                g.citing(vertices[k], parameters.lastyear, buffer);
+                checksum += buffer.size();
+            }
+            packedciting = std::min(packedciting, since(start));
+            
+            start = std::chrono::steady_clock::now();
+            for (unsigned long k = 0; k < vertices.size(); k++) {
+                double d = g.disrupt(vertices[k], parameters.lastyear, workspace);
+                if (d == d) {
+                    packedsum += d;
+                }
+            }
+            packeddisrupt = std::min(packeddisrupt, since(start));
+            
+            double seconds = panel(g, vertices, parameters, threads, Panel::SERIES);
+            packedseries = std::min(packedseries, seconds);
+        }
+        
+        std::remove(vertexfile.c_str());
+        std::remove(edgefile.c_str());
+        
+        unsigned long n = graph.vertices.size();
+        json << (s > 0 ? ",\n" : "\n");
+        json << "    {\"vertices\": " << n << ", \"edges\": " << graph.edges.size();
+        json << ", \"load_seconds\": " << load;
+        json << ", \"cited_ns_per_vertex\": " << 1e9*cited/n;
+        json << ", \"citing_ns_per_vertex\": " << 1e9*citing/n;
+        json << ", \"indegree_ns_per_vertex\": " << 1e9*indegree/n;
+        json << ", \"disrupt_ns_per_vertex\": " << 1e9*disrupt/n;
+        if (cachebytes > 0) {
+            json << ", \"disrupt_cached_ns_per_vertex\": " << 1e9*cached/n;
+            json << ", \"cache_hits\": " << cachestats.hits;
+            json << ", \"cache_misses\": " << cachestats.misses;
+            json << ", \"cache_entries\": " << cachestats.entries;
+            json << ", \"cache_bytes_used\": " << cachestats.bytes;
+            json << ", \"disrupt_cached_sum\": " << cachedsum/repetitions;
+        }
+        json << ", \"panel_series_seconds\": " << series;
+        json << ", \"panel_sweep_seconds\": " << sweep;
+        json << ", \"adjacency_bytes\": " << bytes;
+        json << ", \"compressed_adjacency_bytes\": " << packedbytes;
+        json << ", \"compress_seconds\": " << compress;
+        json << ", \"compressed_cited_ns_per_vertex\": " << 1e9*packedcited/n;
+        json << ", \"compressed_citing_ns_per_vertex\": " << 1e9*packedciting/n;
+        json << ", \"compressed_disrupt_ns_per_vertex\": " << 1e9*packeddisrupt/n;
+        json << ", \"compressed_panel_series_seconds\": " << packedseries;
+        json << ", \"compressed_disrupt_sum\": " << packedsum/repetitions;
+        json << ", \"checksum\": " << checksum/repetitions;
+        json << ", \"disrupt_sum\": " << sum/repetitions << "}";
+    }
+    json << "\n  ]\n}\n";
+    
+    if (outputfile.empty()) {
+        std::cout << json.str();
+    }
+    else {
+        std::ofstream output(outputfile.c_str());
+        output << json.str();
+        output.close();
+        if (output.fail()) {
+            std::cout << "could not write the file '" << outputfile << "'" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+    
+    return 0;
+}
@@ -0,0 +1,186 @@
+//-----------------------------------------------------------------------------
+// File        : citationgraph.h
+// Description : Seeded generator of synthetic evolving citation graphs
+//-----------------------------------------------------------------------------
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the University of Michigan nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL RUSSELL J. FUNK OR JASON OWEN-SMITH BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+// Author    : Russell J. Funk
+// Email     : funk@umich.edu
+// Web page  : http://www-personal.umich.edu/~funk/index.html
+// Location  : University of Michigan, Ann Arbor, Michigan
+// Date      : December 15, 2012
+// Reference : http://arxiv.org/abs/1212.3559 (pp. 6-8 and pp. 24-25)
+//-----------------------------------------------------------------------------
+
+#ifndef _CITATIONGRAPH_H
+#define _CITATIONGRAPH_H
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+// a synthetic citation graph grows year by year, with more vertices in later
+// years; every vertex cites a number of distinct vertices of earlier years,
+// each chosen either in proportion to the citations it has received so far
+// plus one (preferential attachment) or uniformly. the share of preferential
+// choices, skew, sets how heavily citations pile up on hubs: 0 gives a
+// uniform random graph and 1 pure preferential attachment
+//
+// the generator draws only raw 64-bit numbers from std::mt19937_64, whose
+// sequence the standard fixes, so a seed gives the same graph with every
+// compiler and standard library
+struct CitationGraphParameters {
+    unsigned long vertices;  // number of vertices
+    unsigned long firstyear; // years of the vertices
+    unsigned long lastyear;
+    unsigned long outdegree; // mean number of citations made per vertex
+    double skew;             // share of preferential choices, 0 .. 1
+    unsigned long seed;
+    
+    CitationGraphParameters()
+        : vertices(100000), firstyear(1976), lastyear(2010), outdegree(8),
+          skew(0.5), seed(1) {}
+};
+
+// vertices (id, year) in id and year order and edges (citing, cited)
+struct CitationGraph {
+    std::vector<std::pair<unsigned long, unsigned long> > vertices;
+    std::vector<std::pair<unsigned long, unsigned long> > edges;
+};
+
+// first id of the generated vertices, so that ids look like patent numbers
+static const unsigned long citationgraphfirstid = 3000000;
+
+// uniform integer in 0 .. n - 1 and uniform real in [0, 1)
+inline unsigned long citationgraphdraw(std::mt19937_64 &random, unsigned long n) {
+    return random() % n;
+}
+
+inline double citationgraphuniform(std::mt19937_64 &random) {
+    return (random() >> 11)*(1.0/9007199254740992.0);
+}
+
+// generate a citation graph
+inline void generate(const CitationGraphParameters &parameters, CitationGraph &graph) {
+    
+    std::mt19937_64 random(parameters.seed);
+    unsigned long n = parameters.vertices;
+    unsigned long years = parameters.lastyear - parameters.firstyear + 1;
+    
+    // years with linearly growing numbers of vertices: the square root of a
+    // uniform number has a linearly rising density
+    std::vector<unsigned long> offsets(n);
+    for (unsigned long k = 0; k < n; k++) {
+        offsets[k] = std::min<unsigned long>(
+            years - 1, std::sqrt(citationgraphuniform(random))*years);
+    }
+    std::sort(offsets.begin(), offsets.end());
+    
+    graph.vertices.resize(n);
+    for (unsigned long k = 0; k < n; k++) {
+        graph.vertices[k] = std::make_pair(citationgraphfirstid + k,
+                                           parameters.firstyear + offsets[k]);
+    }
+    
+    // one entry per vertex and per citation received, for vertices of years
+    // before the current one; the citations received during the current
+    // year are added once it is over
+    std::vector<unsigned long> targets;
+    std::vector<unsigned long> pending;
+    targets.reserve(n*(parameters.outdegree + 1));
+    
+    graph.edges.clear();
+    graph.edges.reserve(n*parameters.outdegree);
+    
+    std::vector<unsigned long> chosen;
+    unsigned long earlier = 0;
+    
+    for (unsigned long k = 0; k < n; k++) {
+        
+        // entering a new year, the vertices of the previous one become
+        // citable
+        if (k > 0 && offsets[k] != offsets[k - 1]) {
+            for (; earlier < k; earlier++) {
+                targets.push_back(earlier);
+            }
+            targets.insert(targets.end(), pending.begin(), pending.end());
+            pending.clear();
+        }
+        if (earlier == 0) {
+            continue;
+        }
+        
+        // between none and twice the mean number of citations, to distinct
+        // vertices, as far as there are enough of them
+        unsigned long m = std::min(citationgraphdraw(random, 2*parameters.outdegree + 1),
+                                   earlier);
+        chosen.clear();
+        while (chosen.size() < m) {
+            unsigned long cited;
+            if (citationgraphuniform(random) < parameters.skew) {
+                cited = targets[citationgraphdraw(random, targets.size())];
+            }
+            else {
+                cited = citationgraphdraw(random, earlier);
+            }
+            if (std::find(chosen.begin(), chosen.end(), cited) == chosen.end()) {
+                chosen.push_back(cited);
+            }
+        }
+        
+        for (unsigned long e = 0; e < chosen.size(); e++) {
+            graph.edges.push_back(std::make_pair(graph.vertices[k].first,
+                                                 graph.vertices[chosen[e]].first));
+            pending.push_back(chosen[e]);
+        }
+    }
+}
+
+// write a citation graph as the vertex and edge csv files EDGraph reads;
+// returns false if a file cannot be written
+inline bool write(const CitationGraph &graph, const std::string &vertexfile,
+                  const std::string &edgefile) {
+    
+    std::ofstream vertices(vertexfile.c_str());
+    for (unsigned long k = 0; k < graph.vertices.size(); k++) {
+        vertices << graph.vertices[k].first << "," << graph.vertices[k].second << "\n";
+    }
+    vertices.close();
+    
+    std::ofstream edges(edgefile.c_str());
+    for (unsigned long k = 0; k < graph.edges.size(); k++) {
+        edges << graph.edges[k].first << "," << graph.edges[k].second << "\n";
+    }
+    edges.close();
+    
+    return !vertices.fail() && !edges.fail();
+}
+
+#endif
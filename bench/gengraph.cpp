@@ -0,0 +1,98 @@
+//-----------------------------------------------------------------------------
+// File        : gengraph.cpp
+// Description : Writes a synthetic citation graph as csv files
+//-----------------------------------------------------------------------------
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the University of Michigan nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL RUSSELL J. FUNK OR JASON OWEN-SMITH BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+// Author    : Russell J. Funk
+// Email     : funk@umich.edu
+// Web page  : http://www-personal.umich.edu/~funk/index.html
+// Location  : University of Michigan, Ann Arbor, Michigan
+// Date      : December 15, 2012
+// Reference : http://arxiv.org/abs/1212.3559 (pp. 6-8 and pp. 24-25)
+//-----------------------------------------------------------------------------
+
+// to compile and use
+
+// g++ -std=c++11 -O2 gengraph.cpp -o gengraph
+
+// ./gengraph [--vertices n] [--years first last] [--outdegree m] [--skew s]
+//     [--seed k] vertices.csv edges.csv
+
+// writes a synthetic citation graph (see citationgraph.h) that the edgraph
+// program and the benchmarks read like real data
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "citationgraph.h"
+
+int main(int argc, char* argv[]) {
+    
+    CitationGraphParameters parameters;
+    
+    std::vector<std::string> args;
+    for (int k = 1; k < argc; k++) {
+        std::string arg = argv[k];
+        if (arg == "--vertices" && k + 1 < argc) {
+            parameters.vertices = strtoul(argv[++k], NULL, 10);
+        }
+        else if (arg == "--years" && k + 2 < argc) {
+            parameters.firstyear = strtoul(argv[++k], NULL, 10);
+            parameters.lastyear = strtoul(argv[++k], NULL, 10);
+        }
+        else if (arg == "--outdegree" && k + 1 < argc) {
+            parameters.outdegree = strtoul(argv[++k], NULL, 10);
+        }
+        else if (arg == "--skew" && k + 1 < argc) {
+            parameters.skew = atof(argv[++k]);
+        }
+        else if (arg == "--seed" && k + 1 < argc) {
+            parameters.seed = strtoul(argv[++k], NULL, 10);
+        }
+        else {
+            args.push_back(arg);
+        }
+    }
+    
+    if (args.size() != 2 || parameters.lastyear < parameters.firstyear) {
+        std::cout << "usage: " << argv[0];
+        std::cout << " [--vertices n] [--years first last] [--outdegree m] [--skew s] [--seed k] vertexfile edgefile" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    
+    CitationGraph graph;
+    generate(parameters, graph);
+    if (!write(graph, args[0], args[1])) {
+        std::cout << "could not write the files '" << args[0] << "' and '" << args[1] << "'" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    
+    std::cout << graph.vertices.size() << " vertices, " << graph.edges.size() << " edges" << std::endl;
+    return 0;
+}
@@ -0,0 +1,320 @@
+//-----------------------------------------------------------------------------
+// File        : approx.cpp
+// Description : Estimates the metrics of vertices with huge neighborhoods
+//-----------------------------------------------------------------------------
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the University of Michigan nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL RUSSELL J. FUNK OR JASON OWEN-SMITH BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+// Author    : Russell J. Funk
+// Email     : funk@umich.edu
+// Web page  : http://www-personal.umich.edu/~funk/index.html
+// Location  : University of Michigan, Ann Arbor, Michigan
+// Date      : December 15, 2012
+// Reference : http://arxiv.org/abs/1212.3559 (pp. 6-8 and pp. 24-25)
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "edgraph_v1.h"
+
+// the exact metrics count the distinct vertices in the union of the lists of
+// citations following the focal vertex, to it and to each predecessor, which
+// takes as long as the lists are. the estimate instead samples citations,
+// i.e. positions in these lists: a citer sampled from the list of the focal
+// vertex is weighted by one over the number of times it cites the focal
+// vertex, and one sampled from the lists of the predecessors by one over the
+// number of times it cites any of them, so that the mean weight of, say,
+// the citers of predecessors that do not cite the focal vertex times the
+// length of the lists is an unbiased estimate of bonly (Karp and Luby's
+// estimator of the size of a union). what a citer cites is read from its
+// own, short, list of citations made. fonly and both are counted exactly if
+// the focal vertex's own list is short enough, and the confidence interval
+// follows from the variances of the estimates by the delta method
+
+// citations sampled from each list at a time, and the normal quantile of a
+// 95% confidence interval
+static const unsigned long ROUND = 256;
+static const double Z95 = 1.959964;
+
+// running sums of the weights of a sample, for its means and (co)variances
+struct Sums {
+    unsigned long n;
+    double x;
+    double y;
+    double xx;
+    double yy;
+    double xy;
+    
+    Sums() : n(0), x(0), y(0), xx(0), yy(0), xy(0) {}
+    
+    void add(double wx, double wy) {
+        n++;
+        x += wx;
+        y += wy;
+        xx += wx*wx;
+        yy += wy*wy;
+        xy += wx*wy;
+    }
+    
+    // (co)variance of the means of the weights; weights are between 0 and
+    // 1, and the variances count one more weight of each, so that a sample
+    // that happens to miss the rarer weights (e.g. of citers citing more
+    // than one predecessor) does not claim to be exact. no sample, no
+    // variance: the counts were not estimated
+    double varx() const { return n > 0 ? (xx + 1 - (x + 1)*(x + 1)/(n + 2))/(n + 1)/n : 0; }
+    double vary() const { return n > 0 ? (yy + 1 - (y + 1)*(y + 1)/(n + 2))/(n + 1)/n : 0; }
+    double cov() const { return n > 1 ? (xy - x*y/n)/(n - 1)/n : 0; }
+};
+
+// metrics and an exact interval
+static Estimate exact(const Metrics &m) {
+    Estimate estimate;
+    estimate.metrics = m;
+    estimate.low = m.disrupt;
+    estimate.high = m.disrupt;
+    estimate.approximated = false;
+    estimate.samples = 0;
+    return estimate;
+}
+
+// estimate the metrics of vertex i at endtime by sampling
+template <typename Index, typename Time>
+bool EDGraphT<Index, Time>::sample(unsigned long i, unsigned long endtime,
+                                   unsigned long threshold, double error,
+                                   Estimate &estimate) const {
+    
+    unsigned long focaltime = times_[i];
+    unsigned long fbegin = EDGraphT::citingend(i, focaltime);
+    unsigned long fend = EDGraphT::citingend(i, endtime);
+    unsigned long sf = fend > fbegin ? fend - fbegin : 0;
+    
+    // the distinct predecessors, and their lists of citations following
+    // vertex i, end to end
+    std::vector<unsigned long> predecessors;
+    EDGraphT::forcited(i, [&](unsigned long, unsigned long b) {
+        predecessors.push_back(b);
+    });
+    std::sort( predecessors.begin(), predecessors.end() );
+    predecessors.erase( std::unique( predecessors.begin(), predecessors.end() ),
+                        predecessors.end() );
+    
+    std::vector<unsigned long> begins(predecessors.size());
+    std::vector<unsigned long> starts(predecessors.size() + 1, 0);
+    for (unsigned long k = 0; k < predecessors.size(); k++) {
+        begins[k] = EDGraphT::citingend(predecessors[k], focaltime);
+        unsigned long end = EDGraphT::citingend(predecessors[k], endtime);
+        starts[k + 1] = starts[k] + (end > begins[k] ? end - begins[k] : 0);
+    }
+    unsigned long sb = starts.back();
+    
+    // sampling stops at threshold citations, but never before two rounds:
+    // the variances behind the interval are too unsteady on fewer samples
+    // for the interval to be trusted. where there are no more citations
+    // than that, counting them is no dearer than sampling
+    unsigned long limit = std::max(threshold, 2*ROUND);
+    if (sf + sb <= limit) {
+        return false;
+    }
+    
+    // the times vertex c cites vertex i and the times it cites predecessors
+    auto cites = [&](unsigned long c, unsigned long &ci, unsigned long &cb) {
+        ci = 0;
+        cb = 0;
+        EDGraphT::forcited(c, [&](unsigned long, unsigned long cited) {
+            if (cited == i) {
+                ci++;
+            }
+            if (std::binary_search(predecessors.begin(), predecessors.end(), cited)) {
+                cb++;
+            }
+        });
+    };
+    
+    // the citers of vertex i itself are counted exactly if there are few
+    // enough of them, and so are the citers of the predecessors if there
+    // are no more of them than two rounds would sample; if both are, so is
+    // everything
+    bool fexact = sf <= threshold;
+    bool bexact = sb <= 2*ROUND;
+    if (fexact && bexact) {
+        return false;
+    }
+    
+    // repeated citations by one vertex are next to each other
+    double fonly = 0;
+    double both = 0;
+    if (fexact) {
+        unsigned long previous = ULONG_MAX;
+        EDGraphT::forciting(i, fbegin, fend, [&](unsigned long c, unsigned long) {
+            if (c == previous) {
+                return;
+            }
+            previous = c;
+            unsigned long ci;
+            unsigned long cb;
+            cites(c, ci, cb);
+            if (cb > 0) {
+                both++;
+            }
+            else {
+                fonly++;
+            }
+        });
+    }
+    
+    // the citers of the predecessors are counted through the weights below,
+    // which add up to one for each vertex citing predecessors but not
+    // vertex i
+    double bonly = 0;
+    if (bexact) {
+        for (unsigned long k = 0; k < predecessors.size(); k++) {
+            unsigned long end = begins[k] + starts[k + 1] - starts[k];
+            EDGraphT::forciting(predecessors[k], begins[k], end,
+                                [&](unsigned long c, unsigned long) {
+                unsigned long ci;
+                unsigned long cb;
+                cites(c, ci, cb);
+                bonly += ci == 0 ? 1.0/cb : 0;
+            });
+        }
+    }
+    
+    // the weights of fonly and both from the list of vertex i, and of bonly
+    // from those of the predecessors
+    Sums fsums;
+    Sums bsums;
+    std::mt19937_64 random(ids_[i]*0x9e3779b97f4a7c15ULL ^ endtime);
+    
+    double cd = 0;
+    double se = 0;
+    for (;;) {
+        if (!fexact) {
+            std::uniform_int_distribution<unsigned long> position(fbegin, fend - 1);
+            for (unsigned long k = 0; k < ROUND; k++) {
+                unsigned long ci;
+                unsigned long cb;
+                cites(EDGraphT::citingat(i, position(random)), ci, cb);
+                fsums.add(cb == 0 ? 1.0/ci : 0, cb > 0 ? 1.0/ci : 0);
+            }
+            fonly = sf*fsums.x/fsums.n;
+            both = sf*fsums.y/fsums.n;
+        }
+        if (!bexact) {
+            std::uniform_int_distribution<unsigned long> position(0, sb - 1);
+            for (unsigned long k = 0; k < ROUND; k++) {
+                unsigned long p = position(random);
+                unsigned long b = std::upper_bound(starts.begin(), starts.end(), p) -
+                                  starts.begin() - 1;
+                unsigned long ci;
+                unsigned long cb;
+                cites(EDGraphT::citingat(predecessors[b], begins[b] + p - starts[b]), ci,
+                      cb);
+                bsums.add(ci == 0 ? 1.0/cb : 0, 0);
+            }
+            bonly = sb*bsums.x/bsums.n;
+        }
+        
+        // the interval by the delta method, from the gradient of
+        // (fonly - both)/(fonly + both + bonly) in the three counts
+        double n = fonly + both + bonly;
+        cd = (fonly - both)/n;
+        if (n > 0) {
+            double gf = (2*both + bonly)/(n*n);
+            double gb = -(2*fonly + bonly)/(n*n);
+            double go = -(fonly - both)/(n*n);
+            double variance = gf*gf*sf*sf*fsums.varx() + gb*gb*sf*sf*fsums.vary() +
+                              2*gf*gb*sf*sf*fsums.cov() + go*go*sb*sb*bsums.varx();
+            se = std::sqrt(std::max(variance, 0.0));
+        }
+        if ((Z95*se <= error && fsums.n + bsums.n >= 2*ROUND) ||
+            fsums.n + bsums.n >= limit) {
+            break;
+        }
+    }
+    
+    unsigned long indegree = fend - citingoffsets_[i];
+    estimate.metrics = tally((unsigned long)std::floor(fonly + 0.5),
+                             (unsigned long)std::floor(both + 0.5),
+                             (unsigned long)std::floor(bonly + 0.5), indegree);
+    estimate.metrics.disrupt = cd;
+    estimate.metrics.radical = cd*indegree;
+    estimate.low = std::max(cd - Z95*se, -1.0);
+    estimate.high = std::min(cd + Z95*se, 1.0);
+    estimate.approximated = true;
+    estimate.samples = fsums.n + bsums.n;
+    return true;
+}
+
+// return the metrics of a vertex estimated from a sample, or exact ones
+template <typename Index, typename Time>
+Estimate EDGraphT<Index, Time>::metrics_approx(unsigned long focalvertex,
+                                               unsigned long endtime,
+                                               unsigned long threshold,
+                                               double error) const {
+    
+    Estimate estimate;
+    unsigned long i;
+    if (EDGraphT::index(focalvertex, i) && times_[i] != notime_ &&
+        EDGraphT::sample(i, endtime, threshold, error, estimate)) {
+        return estimate;
+    }
+    return exact(EDGraphT::metrics(focalvertex, endtime));
+}
+
+template <typename Index, typename Time>
+Estimate EDGraphT<Index, Time>::metrics_approx(unsigned long focalvertex,
+                                               unsigned long endtime,
+                                               unsigned long threshold,
+                                               double error,
+                                               Workspace &workspace) const {
+    
+    Estimate estimate;
+    unsigned long i;
+    if (EDGraphT::index(focalvertex, i) && times_[i] != notime_ &&
+        EDGraphT::sample(i, endtime, threshold, error, estimate)) {
+        return estimate;
+    }
+    return exact(EDGraphT::metrics(focalvertex, endtime, workspace));
+}
+
+// the members above for the configurations compiled into the library
+template Estimate EDGraphT<unsigned long, unsigned long>::metrics_approx(
+    unsigned long, unsigned long, unsigned long, double) const;
+template Estimate EDGraphT<unsigned long, unsigned long>::metrics_approx(
+    unsigned long, unsigned long, unsigned long, double, Workspace &) const;
+template Estimate EDGraphT<uint32_t, uint32_t>::metrics_approx(
+    unsigned long, unsigned long, unsigned long, double) const;
+template Estimate EDGraphT<uint32_t, uint32_t>::metrics_approx(
+    unsigned long, unsigned long, unsigned long, double, Workspace &) const;
+template Estimate EDGraphT<uint32_t, uint16_t>::metrics_approx(
+    unsigned long, unsigned long, unsigned long, double) const;
+template Estimate EDGraphT<uint32_t, uint16_t>::metrics_approx(
+    unsigned long, unsigned long, unsigned long, double, Workspace &) const;
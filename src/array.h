@@ -0,0 +1,100 @@
+//-----------------------------------------------------------------------------
+// File        : array.h
+// Description : Declares a read-only array that owns or refers to its elements
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012, Russell J. Funk and Jason Owen Smith
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the University of Michigan nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL RUSSELL J. FUNK OR JASON OWEN-SMITH BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+// Author    : Russell J. Funk
+// Email     : funk@umich.edu
+// Web page  : http://www-personal.umich.edu/~funk/index.html
+// Location  : University of Michigan, Ann Arbor, Michigan
+// Date      : December 15, 2012
+// Reference : http://arxiv.org/abs/1212.3559 (pp. 6-8 and pp. 24-25)
+//-----------------------------------------------------------------------------
+
+#ifndef _ARRAY_H
+#define _ARRAY_H
+
+#include <cstddef>
+#include <vector>
+
+// read-only array that either owns its elements, moved in from a vector, or
+// refers to elements stored elsewhere, e.g., in a memory-mapped snapshot;
+// element access is the same in both cases
+template <typename T>
+class Array {
+    
+private:
+    
+    // owned elements, if any, and the elements in use
+    std::vector<T> owned_;
+    const T *data_;
+    unsigned long size_;
+    
+    // not copyable, since data_ may point into owned_
+    Array(const Array &);
+    Array &operator=(const Array &);
+    
+public:
+    
+    Array() : data_(NULL), size_(0) {
+    }
+    
+    // take over the elements of v, leaving v empty
+    void assign(std::vector<T> &v) {
+        owned_.swap(v);
+        std::vector<T>().swap(v);
+        data_ = owned_.empty() ? NULL : &owned_[0];
+        size_ = owned_.size();
+    }
+    
+    // refer to size elements stored at data, which must outlive the array
+    void refer(const T *data, unsigned long size) {
+        std::vector<T>().swap(owned_);
+        data_ = data;
+        size_ = size;
+    }
+    
+    const T &operator[](unsigned long i) const {
+        return data_[i];
+    }
+    
+    const T *begin() const {
+        return data_;
+    }
+    
+    const T *end() const {
+        return data_ + size_;
+    }
+    
+    unsigned long size() const {
+        return size_;
+    }
+    
+};
+
+#endif
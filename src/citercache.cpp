@@ -0,0 +1,187 @@
+//-----------------------------------------------------------------------------
+// File        : citercache.cpp
+// Description : Shared cache of the citers of heavily cited vertices
+//-----------------------------------------------------------------------------
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the University of Michigan nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL RUSSELL J. FUNK OR JASON OWEN-SMITH BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+// Author    : Russell J. Funk
+// Email     : funk@umich.edu
+// Web page  : http://www-personal.umich.edu/~funk/index.html
+// Location  : University of Michigan, Ann Arbor, Michigan
+// Date      : December 15, 2012
+// Reference : http://arxiv.org/abs/1212.3559 (pp. 6-8 and pp. 24-25)
+//-----------------------------------------------------------------------------
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+#include "citercache.h"
+
+// numbers handed out to graphs so far, by caches of every index type
+static std::atomic<unsigned long> graphs(0);
+
+// bytes taken by an entry
+template <typename Index>
+static unsigned long size(const typename CiterCacheT<Index>::Entry &entry) {
+    return sizeof(entry) + entry.citers.size()*sizeof(Index) +
+           entry.bits.size()*sizeof(uint64_t) +
+           entry.repeats.size()*sizeof(uint32_t);
+}
+
+// whether vertex is among the citers
+template <typename Index>
+bool CiterCacheT<Index>::Entry::contains(unsigned long vertex) const {
+    if (!bits.empty()) {
+        return (bits[vertex >> 6] >> (vertex & 63)) & 1;
+    }
+    return std::binary_search(citers.begin(), citers.end(), (Index)vertex);
+}
+
+// cache of up to bytes bytes of entries
+template <typename Index>
+CiterCacheT<Index>::CiterCacheT(unsigned long bytes, unsigned long threshold)
+    : budget_(bytes/shards), threshold_(threshold), hits_(0), misses_(0),
+      insertions_(0), evictions_(0), rejections_(0) {
+    for (unsigned int s = 0; s < shards; s++) {
+        shards_[s].bytes = 0;
+    }
+}
+
+// in-degree a vertex needs for its citers to be cached
+template <typename Index>
+unsigned long CiterCacheT<Index>::threshold() const {
+    return threshold_;
+}
+
+// a number no other call returns
+template <typename Index>
+unsigned long CiterCacheT<Index>::newgraph() {
+    return graphs.fetch_add(1) + 1;
+}
+
+// shard of a key
+template <typename Index>
+typename CiterCacheT<Index>::Shard &CiterCacheT<Index>::shard(const Key &key) {
+    return shards_[(KeyHash()(key) >> 7) % shards];
+}
+
+// the entry of a vertex of graph with citations ending at end
+template <typename Index>
+std::shared_ptr<const typename CiterCacheT<Index>::Entry>
+CiterCacheT<Index>::find(unsigned long graph, unsigned long vertex,
+                         unsigned long end) {
+    
+    Key key(graph, vertex, end);
+    Shard &s = CiterCacheT::shard(key);
+    
+    std::lock_guard<std::mutex> guard(s.lock);
+    typename std::unordered_map<Key, typename List::iterator, KeyHash>::iterator it1 =
+        s.index.find(key);
+    if (it1 == s.index.end()) {
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return std::shared_ptr<const Entry>();
+    }
+    
+    // now the most recently used
+    s.entries.splice(s.entries.begin(), s.entries, it1->second);
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    return it1->second->second;
+}
+
+// add the entry of a vertex of graph with citations ending at end
+template <typename Index>
+std::shared_ptr<const typename CiterCacheT<Index>::Entry>
+CiterCacheT<Index>::insert(unsigned long graph, unsigned long vertex,
+                           unsigned long end, std::shared_ptr<const Entry> entry) {
+    
+    unsigned long bytes = size<Index>(*entry);
+    if (bytes > budget_) {
+        rejections_.fetch_add(1, std::memory_order_relaxed);
+        return entry;
+    }
+    
+    Key key(graph, vertex, end);
+    Shard &s = CiterCacheT::shard(key);
+    
+    std::lock_guard<std::mutex> guard(s.lock);
+    
+    // another thread may have got there first
+    typename std::unordered_map<Key, typename List::iterator, KeyHash>::iterator it1 =
+        s.index.find(key);
+    if (it1 != s.index.end()) {
+        return it1->second->second;
+    }
+    
+    while (s.bytes + bytes > budget_) {
+        s.bytes -= size<Index>(*s.entries.back().second);
+        s.index.erase(s.entries.back().first);
+        s.entries.pop_back();
+        evictions_.fetch_add(1, std::memory_order_relaxed);
+    }
+    
+    s.entries.push_front(std::make_pair(key, entry));
+    s.index[key] = s.entries.begin();
+    s.bytes += bytes;
+    insertions_.fetch_add(1, std::memory_order_relaxed);
+    return entry;
+}
+
+// hit, miss and size counts so far
+template <typename Index>
+CiterCacheStats CiterCacheT<Index>::stats() {
+    
+    CiterCacheStats stats;
+    stats.hits = hits_.load();
+    stats.misses = misses_.load();
+    stats.insertions = insertions_.load();
+    stats.evictions = evictions_.load();
+    stats.rejections = rejections_.load();
+    stats.entries = 0;
+    stats.bytes = 0;
+    for (unsigned int s = 0; s < shards; s++) {
+        std::lock_guard<std::mutex> guard(shards_[s].lock);
+        stats.entries += shards_[s].entries.size();
+        stats.bytes += shards_[s].bytes;
+    }
+    return stats;
+}
+
+// drop all entries
+template <typename Index>
+void CiterCacheT<Index>::clear() {
+    for (unsigned int s = 0; s < shards; s++) {
+        std::lock_guard<std::mutex> guard(shards_[s].lock);
+        shards_[s].entries.clear();
+        shards_[s].index.clear();
+        shards_[s].bytes = 0;
+    }
+}
+
+// the caches of the index types compiled into the library
+template class CiterCacheT<unsigned long>;
+template class CiterCacheT<uint32_t>;
@@ -0,0 +1,177 @@
+//-----------------------------------------------------------------------------
+// File        : citercache.h
+// Description : Shared cache of the citers of heavily cited vertices
+//-----------------------------------------------------------------------------
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the University of Michigan nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL RUSSELL J. FUNK OR JASON OWEN-SMITH BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+// Author    : Russell J. Funk
+// Email     : funk@umich.edu
+// Web page  : http://www-personal.umich.edu/~funk/index.html
+// Location  : University of Michigan, Ann Arbor, Michigan
+// Date      : December 15, 2012
+// Reference : http://arxiv.org/abs/1212.3559 (pp. 6-8 and pp. 24-25)
+//-----------------------------------------------------------------------------
+
+#ifndef _CITERCACHE_H
+#define _CITERCACHE_H
+
+#include <stdint.h>
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// hit, miss and size counts of a CiterCacheT
+struct CiterCacheStats {
+    unsigned long hits;
+    unsigned long misses;
+    unsigned long insertions;
+    unsigned long evictions;
+    unsigned long rejections; // entries too large for the cache
+    unsigned long entries;
+    unsigned long bytes;
+};
+
+// bounded cache, shared by any number of threads, of the citers of heavily
+// cited vertices up to an end time, sorted by dense index so that whether a
+// vertex is among them takes a binary search (see EDGraphT::cache)
+//
+// entries are keyed by graph (see newgraph()), vertex and the end of its
+// citations up to the end time, so that any number of graphs can share a
+// cache and end times with the same citations share an entry. the
+// least recently used entries are evicted to keep the cache within its
+// budget of bytes; the cache is split into shards, each with its own lock
+// and its share of the budget, so that threads rarely wait on one another,
+// and entries are handed out as shared pointers, so that they can be used
+// after the lock is released, even while being evicted. Index is the index
+// type of the graph
+template <typename Index>
+class CiterCacheT {
+    
+public:
+    
+    // the distinct citers of a vertex up to an end time, either in index
+    // order or, when that is smaller, as one bit per vertex of the graph,
+    // and, if the vertex is cited more than once by the same vertex, the
+    // number of repeated citations in each prefix of its time-sorted
+    // citations up to the end time
+    struct Entry {
+        std::vector<Index> citers;
+        std::vector<uint64_t> bits;
+        std::vector<uint32_t> repeats;
+        
+        // whether vertex (dense index) is among the citers
+        bool contains(unsigned long vertex) const;
+    };
+    
+private:
+    
+    struct Key {
+        unsigned long graph;
+        unsigned long vertex;
+        unsigned long end;
+        
+        Key(unsigned long g, unsigned long v, unsigned long e)
+            : graph(g), vertex(v), end(e) {}
+        
+        bool operator==(const Key &key) const {
+            return graph == key.graph && vertex == key.vertex && end == key.end;
+        }
+    };
+    
+    struct KeyHash {
+        std::size_t operator()(const Key &key) const {
+            return (key.graph*0xff51afd7ed558ccdULL ^ key.vertex)*0x9e3779b97f4a7c15ULL ^
+                   key.end;
+        }
+    };
+    
+    typedef std::list<std::pair<Key, std::shared_ptr<const Entry> > > List;
+    
+    // one shard: entries from most to least recently used, and where each
+    // key is in that list
+    struct Shard {
+        std::mutex lock;
+        List entries;
+        std::unordered_map<Key, typename List::iterator, KeyHash> index;
+        unsigned long bytes;
+    };
+    
+    static const unsigned int shards = 16;
+    Shard shards_[shards];
+    
+    // budget of each shard in bytes, and the in-degree entries need
+    unsigned long budget_;
+    unsigned long threshold_;
+    
+    std::atomic<unsigned long> hits_;
+    std::atomic<unsigned long> misses_;
+    std::atomic<unsigned long> insertions_;
+    std::atomic<unsigned long> evictions_;
+    std::atomic<unsigned long> rejections_;
+    
+    // shard of a key
+    Shard &shard(const Key &key);
+    
+public:
+    
+    // cache of up to bytes bytes of entries, for predecessors with at least
+    // threshold citations following the focal vertex up to the end time
+    explicit CiterCacheT(unsigned long bytes, unsigned long threshold = 1024);
+    
+    // citations a predecessor needs for its citers to be cached
+    unsigned long threshold() const;
+    
+    // a number no other call returns, with which a graph keys its entries;
+    // a graph takes a new one whenever it changes, so that its old entries
+    // are never found again and age out of the cache
+    static unsigned long newgraph();
+    
+    // the entry of a vertex (dense index) of graph with citations ending at
+    // end (an offset into the citations), or an empty pointer
+    std::shared_ptr<const Entry> find(unsigned long graph, unsigned long vertex,
+                                      unsigned long end);
+    
+    // add the entry of a vertex of graph with citations ending at end,
+    // evicting the least recently used entries as needed; entries larger
+    // than a shard's share of the budget are not kept. returns the entry
+    std::shared_ptr<const Entry> insert(unsigned long graph, unsigned long vertex,
+                                        unsigned long end,
+                                        std::shared_ptr<const Entry> entry);
+    
+    // hit, miss and size counts so far
+    CiterCacheStats stats();
+    
+    // drop all entries, e.g. to free those of graphs that have changed
+    void clear();
+    
+};
+
+#endif
@@ -0,0 +1,281 @@
+//-----------------------------------------------------------------------------
+// File        : csv.cpp
+// Description : Parallel reader for comma-separated vertex and edge files
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012, Russell J. Funk and Jason Owen Smith
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the University of Michigan nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL RUSSELL J. FUNK OR JASON OWEN-SMITH BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+// Author    : Russell J. Funk
+// Email     : funk@umich.edu
+// Web page  : http://www-personal.umich.edu/~funk/index.html
+// Location  : University of Michigan, Ann Arbor, Michigan
+// Date      : December 15, 2012
+// Reference : http://arxiv.org/abs/1212.3559 (pp. 6-8 and pp. 24-25)
+//-----------------------------------------------------------------------------
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "csv.h"
+#include "mappedfile.h"
+#include "stats.h"
+
+namespace {
+
+// outcome of parsing an integer
+enum ParseResult { PARSE_OK, PARSE_NODIGITS, PARSE_OVERFLOW };
+
+// parse an unsigned integer starting at p, leaving p after its last digit
+inline ParseResult parse(const char *&p, const char *end, unsigned long &value) {
+    
+    const char *start = p;
+    unsigned long v = 0;
+    
+    while (p < end && (unsigned char)(*p - '0') < 10) {
+        unsigned long digit = *p - '0';
+        if (v > (ULONG_MAX - digit)/10) {
+            // skip the rest of the digits so the line can still be reported
+            while (p < end && (unsigned char)(*p - '0') < 10) {
+                p++;
+            }
+            return PARSE_OVERFLOW;
+        }
+        v = 10*v + digit;
+        p++;
+    }
+    if (p == start) {
+        return PARSE_NODIGITS;
+    }
+    value = v;
+    return PARSE_OK;
+}
+
+// skip spaces and tabs
+inline void blanks(const char *&p, const char *end) {
+    while (p < end && (*p == ' ' || *p == '\t')) {
+        p++;
+    }
+}
+
+// what one thread found in its chunk of the file
+struct Chunk {
+    const char *begin;
+    const char *end;
+    std::vector<std::pair<unsigned long, unsigned long> > pairs;
+    std::vector<CSVError> errors; // line numbers relative to the chunk
+    unsigned long nerrors;
+    unsigned long lines;
+};
+
+// parse one chunk; header says whether the first line may be a header
+void parsechunk(Chunk &chunk, bool header, unsigned long maxerrors) {
+    
+    const char *p = chunk.begin;
+    const char *end = chunk.end;
+    
+    chunk.nerrors = 0;
+    chunk.lines = 0;
+    
+    // a rough guess at the number of pairs saves most of the regrowth
+    chunk.pairs.reserve((end - p)/12 + 1);
+    
+    while (p < end) {
+        
+        const char *eol = static_cast<const char *>(memchr(p, '\n', end - p));
+        if (eol == NULL) {
+            eol = end;
+        }
+        chunk.lines++;
+        
+        const char *q = p;
+        unsigned long a = 0;
+        unsigned long b = 0;
+        const char *message = NULL;
+        
+        blanks(q, eol);
+        if (q == eol || (*q == '\r' && q + 1 == eol)) {
+            p = eol + 1; // blank line
+            continue;
+        }
+        if (header && chunk.lines == 1 && (unsigned char)(*q - '0') >= 10) {
+            p = eol + 1; // header line
+            continue;
+        }
+        
+        ParseResult result = parse(q, eol, a);
+        if (result == PARSE_OVERFLOW) {
+            message = "first value overflows an unsigned long";
+        }
+        else if (result == PARSE_NODIGITS) {
+            message = "first value is not an unsigned integer";
+        }
+        else {
+            blanks(q, eol);
+            if (q == eol || *q != ',') {
+                message = "expected a comma after the first value";
+            }
+            else {
+                q++;
+                blanks(q, eol);
+                result = parse(q, eol, b);
+                if (result == PARSE_OVERFLOW) {
+                    message = "second value overflows an unsigned long";
+                }
+                else if (result == PARSE_NODIGITS) {
+                    message = "second value is not an unsigned integer";
+                }
+                else {
+                    blanks(q, eol);
+                    if (q < eol && *q == '\r') {
+                        q++;
+                    }
+                    if (q != eol) {
+                        message = "unexpected characters after the second value";
+                    }
+                }
+            }
+        }
+        
+        if (message == NULL) {
+            chunk.pairs.push_back(std::pair<unsigned long, unsigned long>(a, b));
+        }
+        else {
+            if (chunk.errors.size() < maxerrors) {
+                CSVError error;
+                error.line = chunk.lines;
+                error.message = message;
+                chunk.errors.push_back(error);
+            }
+            chunk.nerrors++;
+        }
+        p = eol + 1;
+    }
+}
+
+}
+
+// read a file of comma-separated pairs of unsigned integers
+bool readcsv(const std::string &file, unsigned int threads,
+             std::vector<std::pair<unsigned long, unsigned long> > &pairs,
+             std::vector<CSVError> &errors, unsigned long &nerrors,
+             unsigned long maxerrors) {
+    
+    pairs.clear();
+    errors.clear();
+    nerrors = 0;
+    
+    MappedFile map;
+    if (!map.open(file)) {
+        return false;
+    }
+    
+    unsigned long lines;
+    return readcsv(map.data(), map.data() + map.size(), true, threads, pairs,
+                   errors, nerrors, lines, maxerrors);
+}
+
+// read the lines in data .. end of a file already in memory
+bool readcsv(const char *data, const char *end, bool header, unsigned int threads,
+             std::vector<std::pair<unsigned long, unsigned long> > &pairs,
+             std::vector<CSVError> &errors, unsigned long &nerrors,
+             unsigned long &lines, unsigned long maxerrors) {
+    
+    pairs.clear();
+    errors.clear();
+    nerrors = 0;
+    lines = 0;
+    
+    unsigned long size = end - data;
+    
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+    if (threads == 0) {
+        threads = 1;
+    }
+    
+    // no point in chunks of less than a megabyte
+    const unsigned long minchunk = 1 << 20;
+    unsigned long nchunks = std::min<unsigned long>(threads, size/minchunk + 1);
+    
+    // cut the file into chunks that each start at the beginning of a line
+    std::vector<Chunk> chunks(nchunks);
+    for (unsigned long k = 0; k < nchunks; k++) {
+        const char *begin = data + k*(size/nchunks);
+        if (k > 0) {
+            const char *eol = static_cast<const char *>(memchr(begin, '\n',
+                                                               end - begin));
+            begin = (eol == NULL) ? end : eol + 1;
+        }
+        chunks[k].begin = begin;
+    }
+    for (unsigned long k = 0; k < nchunks; k++) {
+        chunks[k].end = (k + 1 < nchunks) ? chunks[k + 1].begin : end;
+        chunks[k].begin = std::min(chunks[k].begin, chunks[k].end);
+    }
+    
+    // parse the chunks in parallel
+    std::vector<std::thread> workers;
+    for (unsigned long k = 1; k < nchunks; k++) {
+        workers.push_back(std::thread(parsechunk, std::ref(chunks[k]), false,
+                                      maxerrors));
+    }
+    parsechunk(chunks[0], header, maxerrors);
+    for (unsigned long k = 0; k < workers.size(); k++) {
+        workers[k].join();
+    }
+    
+    // stitch the chunks together in file order
+    unsigned long npairs = 0;
+    for (unsigned long k = 0; k < nchunks; k++) {
+        npairs += chunks[k].pairs.size();
+    }
+    pairs.reserve(npairs);
+    
+    for (unsigned long k = 0; k < nchunks; k++) {
+        pairs.insert(pairs.end(), chunks[k].pairs.begin(), chunks[k].pairs.end());
+        std::vector<std::pair<unsigned long, unsigned long> >().swap(chunks[k].pairs);
+        
+        for (unsigned long e = 0; e < chunks[k].errors.size(); e++) {
+            if (errors.size() < maxerrors) {
+                errors.push_back(chunks[k].errors[e]);
+                errors.back().line += lines;
+            }
+        }
+        nerrors += chunks[k].nerrors;
+        lines += chunks[k].lines;
+    }
+    
+    EDGRAPH_STATS_ADD(STATS_BYTESPARSED, size);
+    EDGRAPH_STATS_ADD(STATS_PAIRSPARSED, pairs.size());
+    
+    return nerrors == 0;
+}
@@ -0,0 +1,79 @@
+//-----------------------------------------------------------------------------
+// File        : csv.h
+// Description : Declares the parallel reader for comma-separated vertex and edge files
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012, Russell J. Funk and Jason Owen Smith
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the University of Michigan nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL RUSSELL J. FUNK OR JASON OWEN-SMITH BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+// Author    : Russell J. Funk
+// Email     : funk@umich.edu
+// Web page  : http://www-personal.umich.edu/~funk/index.html
+// Location  : University of Michigan, Ann Arbor, Michigan
+// Date      : December 15, 2012
+// Reference : http://arxiv.org/abs/1212.3559 (pp. 6-8 and pp. 24-25)
+//-----------------------------------------------------------------------------
+
+#ifndef _CSV_H
+#define _CSV_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+// a malformed line found while reading a csv file
+struct CSVError {
+    unsigned long line;
+    std::string message;
+};
+
+// read a file of comma-separated pairs of unsigned integers, one pair per
+// line, such as vertex-id,time or vertex-id,vertex-id; pairs are returned in
+// file order
+//
+// the file is memory-mapped and cut into newline-aligned chunks that are
+// parsed on threads threads (0 = one per hardware core) without copying or
+// allocating per line. blank lines are skipped, as is a first line that does
+// not begin with a digit (a header). returns false if the file cannot be
+// opened or has malformed lines, i.e., lines that are not two integers
+// separated by a comma or with integers that overflow an unsigned long; the
+// first maxerrors of these are reported in errors, and the total number of
+// malformed lines in nerrors
+bool readcsv(const std::string &file, unsigned int threads,
+             std::vector<std::pair<unsigned long, unsigned long> > &pairs,
+             std::vector<CSVError> &errors, unsigned long &nerrors,
+             unsigned long maxerrors = 10);
+
+// same for the lines in data .. end of a file already in memory, such as a
+// memory-mapped file, which must start at the beginning of a line; header
+// says whether the first line may be a header, and lines returns the number
+// of lines, so that a large file can be read piece by piece with line
+// numbers relative to the first piece
+bool readcsv(const char *data, const char *end, bool header, unsigned int threads,
+             std::vector<std::pair<unsigned long, unsigned long> > &pairs,
+             std::vector<CSVError> &errors, unsigned long &nerrors,
+             unsigned long &lines, unsigned long maxerrors = 10);
+
+#endif
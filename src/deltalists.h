@@ -0,0 +1,312 @@
+//-----------------------------------------------------------------------------
+// File        : deltalists.h
+// Description : Read-only integer lists stored as variable-length differences
+//-----------------------------------------------------------------------------
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the University of Michigan nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL RUSSELL J. FUNK OR JASON OWEN-SMITH BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+// Author    : Russell J. Funk
+// Email     : funk@umich.edu
+// Web page  : http://www-personal.umich.edu/~funk/index.html
+// Location  : University of Michigan, Ann Arbor, Michigan
+// Date      : December 15, 2012
+// Reference : http://arxiv.org/abs/1212.3559 (pp. 6-8 and pp. 24-25)
+//-----------------------------------------------------------------------------
+
+#ifndef _DELTALISTS_H
+#define _DELTALISTS_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+// read-only lists of unsigned integers stored end to end, as an adjacency
+// array is, with each element stored as the difference from the one before
+// it in its list, zigzag-encoded so that decreases stay small too, in 7
+// bits per byte with the high bit set on all but the last byte of each. the
+// lists are also cut into blocks of BLOCK elements, counted from the start
+// of all of them, and every list and block starts over from zero, so that
+// the first element of a block is stored whole; the byte offset of every
+// block is kept. lists of neighbors numbered close to each other, such as
+// the citations to a vertex in time order, mostly take one or two bytes per
+// element, against four or eight stored plainly, and the times of those
+// citations mostly one.
+//
+// elements are addressed by their position e from the start of all the
+// lists, as in the plain array, along with the position first of the start
+// of their list. runs of elements are read with each(), which decodes eight
+// one-byte differences at a time when it can, alone or in step with other
+// lists of the same shape
+template <typename T>
+class DeltaLists {
+    
+    template <typename U> friend class DeltaLists;
+    
+private:
+    
+    // the encoded elements, followed by eight bytes of padding so that eight
+    // bytes can always be loaded at once, and the offset in bytes_ of each
+    // block
+    std::vector<uint8_t> bytes_;
+    std::vector<unsigned long> blocks_;
+    unsigned long size_;
+    
+    // not copyable, for symmetry with Array
+    DeltaLists(const DeltaLists &);
+    DeltaLists &operator=(const DeltaLists &);
+    
+    // decode the difference at p, advancing p past it
+    static unsigned long next(const uint8_t *&p) {
+        unsigned long z = *p & 0x7f;
+        for (unsigned int shift = 7; *p++ & 0x80; shift += 7) {
+            z |= (unsigned long)(*p & 0x7f) << shift;
+        }
+        return (z >> 1) ^ (0 - (z & 1));
+    }
+    
+    // the high bits of the eight bytes at p, which are clear in the last
+    // byte of each difference
+    static uint64_t highbits(const uint8_t *p) {
+        uint64_t word;
+        memcpy(&word, p, sizeof(word));
+        return word & 0x8080808080808080ULL;
+    }
+    
+    // decode a difference of one byte
+    static unsigned long short1(uint8_t b) {
+        unsigned long z = b;
+        return (z >> 1) ^ (0 - (z & 1));
+    }
+    
+    // return the position in bytes_ of element e of the list starting at
+    // position first, with value set to the element before it (zero for the
+    // first of a list or block). the differences before the start of the
+    // list within its block are skipped without being decoded, eight bytes
+    // at a time by counting the bytes that end a difference
+    const uint8_t *seek(unsigned long first, unsigned long e,
+                        unsigned long &value) const {
+        unsigned long start = e - e % BLOCK;
+        const uint8_t *p = &bytes_[blocks_[start/BLOCK]];
+        if (first > start) {
+            unsigned long count = first - start;
+            for (;;) {
+                uint64_t ends = (~highbits(p) & 0x8080808080808080ULL) >> 7;
+                unsigned long n = (unsigned long)((ends*0x0101010101010101ULL) >> 56);
+                if (n >= count) {
+                    break;
+                }
+                p += 8;
+                count -= n;
+            }
+            for (; count > 0; count--) {
+                while (*p++ & 0x80) {
+                }
+            }
+            start = first;
+        }
+        value = 0;
+        for (unsigned long k = start; k < e; k++) {
+            value += next(p);
+        }
+        return p;
+    }
+    
+public:
+    
+    // elements per block
+    static const unsigned long BLOCK = 64;
+    
+    DeltaLists() : size_(0) {
+    }
+    
+    // encode the lists of elements data[offsets[i]] .. data[offsets[i + 1] -
+    // 1] for i = 0 .. lists - 1
+    void assign(const T *data, const unsigned long *offsets, unsigned long lists) {
+        unsigned long size = lists > 0 ? offsets[lists] : 0;
+        bytes_.clear();
+        blocks_.clear();
+        bytes_.reserve(size + 8);
+        blocks_.reserve((size + BLOCK - 1)/BLOCK);
+        unsigned long previous = 0;
+        unsigned long i = 0;
+        for (unsigned long e = 0; e < size; e++) {
+            if (e % BLOCK == 0) {
+                blocks_.push_back(bytes_.size());
+                previous = 0;
+            }
+            for (; offsets[i] <= e; i++) {
+                previous = 0;
+            }
+            unsigned long d = (unsigned long)data[e] - previous;
+            unsigned long z = (d << 1) ^ (0 - (d >> 63));
+            while (z >= 0x80) {
+                bytes_.push_back((uint8_t)(z | 0x80));
+                z >>= 7;
+            }
+            bytes_.push_back((uint8_t)z);
+            previous = data[e];
+        }
+        bytes_.resize(bytes_.size() + 8, 0);
+        bytes_.shrink_to_fit();
+        size_ = size;
+    }
+    
+    // drop the elements, releasing their memory
+    void clear() {
+        std::vector<uint8_t>().swap(bytes_);
+        std::vector<unsigned long>().swap(blocks_);
+        size_ = 0;
+    }
+    
+    unsigned long size() const {
+        return size_;
+    }
+    
+    // memory taken by the encoded elements and the block offsets
+    unsigned long bytes() const {
+        return bytes_.size() + blocks_.size()*sizeof(unsigned long);
+    }
+    
+    // element e of the list starting at position first
+    T at(unsigned long first, unsigned long e) const {
+        unsigned long value;
+        const uint8_t *p = DeltaLists::seek(first, e, value);
+        return (T)(value + next(p));
+    }
+    
+    // call f(e, element e) for the elements from begin to end - 1 of the
+    // list starting at position first, in order
+    template <typename F>
+    void each(unsigned long first, unsigned long begin, unsigned long end, F f) const {
+        if (begin >= end) {
+            return;
+        }
+        unsigned long value;
+        const uint8_t *p = DeltaLists::seek(first, begin, value);
+        for (unsigned long e = begin; e < end; ) {
+            if (e % BLOCK == 0) {
+                value = 0;
+            }
+            unsigned long stop = std::min(end, e - e % BLOCK + BLOCK);
+            while (e < stop) {
+                if (e + 8 <= stop && highbits(p) == 0) {
+                    for (unsigned int k = 0; k < 8; k++) {
+                        value += short1(p[k]);
+                        f(e + k, (T)value);
+                    }
+                    e += 8;
+                    p += 8;
+                }
+                else {
+                    value += next(p);
+                    f(e, (T)value);
+                    e++;
+                }
+            }
+        }
+    }
+    
+    // call f(e, element e, element e of other), where other has lists of
+    // the same lengths, for the elements from begin to end - 1 of the list
+    // starting at position first, in order
+    template <typename U, typename F>
+    void each(const DeltaLists<U> &other, unsigned long first, unsigned long begin,
+              unsigned long end, F f) const {
+        if (begin >= end) {
+            return;
+        }
+        unsigned long value;
+        unsigned long othervalue;
+        const uint8_t *p = DeltaLists::seek(first, begin, value);
+        const uint8_t *q = other.seek(first, begin, othervalue);
+        for (unsigned long e = begin; e < end; ) {
+            if (e % BLOCK == 0) {
+                value = 0;
+                othervalue = 0;
+            }
+            unsigned long stop = std::min(end, e - e % BLOCK + BLOCK);
+            while (e < stop) {
+                if (e + 8 <= stop && (highbits(p) | highbits(q)) == 0) {
+                    for (unsigned int k = 0; k < 8; k++) {
+                        value += short1(p[k]);
+                        othervalue += short1(q[k]);
+                        f(e + k, (T)value, (U)othervalue);
+                    }
+                    e += 8;
+                    p += 8;
+                    q += 8;
+                }
+                else {
+                    value += next(p);
+                    othervalue += next(q);
+                    f(e, (T)value, (U)othervalue);
+                    e++;
+                }
+            }
+        }
+    }
+    
+    // return the first position from begin to end - 1 of the list starting
+    // at position first of an element for which pred is false, or end if
+    // there is none, where pred is true of the elements up to some position
+    // and false after it, as with std::partition_point. the blocks starting
+    // in the range are searched by their first element, which is stored
+    // whole, and then the part of one block in the range is decoded
+    template <typename Pred>
+    unsigned long partition(unsigned long first, unsigned long begin, unsigned long end,
+                            Pred pred) const {
+        if (begin >= end) {
+            return end;
+        }
+        unsigned long low = begin/BLOCK + 1;
+        unsigned long high = (end - 1)/BLOCK + 1;
+        while (low < high) {
+            unsigned long middle = low + (high - low)/2;
+            const uint8_t *p = &bytes_[blocks_[middle]];
+            if (pred((T)next(p))) {
+                low = middle + 1;
+            }
+            else {
+                high = middle;
+            }
+        }
+        unsigned long e = std::max(begin, (low - 1)*BLOCK);
+        unsigned long stop = std::min(end, low*BLOCK);
+        unsigned long value;
+        const uint8_t *p = DeltaLists::seek(first, e, value);
+        for (; e < stop; e++) {
+            value += next(p);
+            if (!pred((T)value)) {
+                return e;
+            }
+        }
+        return stop;
+    }
+    
+};
+
+#endif
@@ -0,0 +1,491 @@
+//-----------------------------------------------------------------------------
+// File        : dictionary.cpp
+// Description : Numbers vertex ids that are strings, e.g. DOIs
+//-----------------------------------------------------------------------------
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the University of Michigan nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL RUSSELL J. FUNK OR JASON OWEN-SMITH BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+// Author    : Russell J. Funk
+// Email     : funk@umich.edu
+// Web page  : http://www-personal.umich.edu/~funk/index.html
+// Location  : University of Michigan, Ann Arbor, Michigan
+// Date      : December 15, 2012
+// Reference : http://arxiv.org/abs/1212.3559 (pp. 6-8 and pp. 24-25)
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "csv.h"
+#include "dictionary.h"
+#include "mappedfile.h"
+#include "stats.h"
+
+// first bytes of a dictionary file, which then holds the number of ids and
+// the size of the arena (64-bit), the offsets of the ids (64-bit) and the
+// arena, in the byte order of the machine, like snapshots
+static const char idsmagic[8] = {'E', 'D', 'G', 'I', 'D', 'S', '0', '1'};
+
+namespace {
+
+// 64-bit FNV-1a hash of an id
+inline uint64_t hash(const char *id, unsigned long length) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (unsigned long k = 0; k < length; k++) {
+        h = (h ^ (unsigned char)id[k])*0x100000001b3ULL;
+    }
+    return h;
+}
+
+// order of ids by their bytes, a prefix coming first
+inline bool before(const IdDictionary::View &a, const IdDictionary::View &b) {
+    int c = memcmp(a.first, b.first, std::min(a.second, b.second));
+    return c < 0 || (c == 0 && a.second < b.second);
+}
+
+inline bool same(const IdDictionary::View &a, const IdDictionary::View &b) {
+    return a.second == b.second && memcmp(a.first, b.first, a.second) == 0;
+}
+
+// skip spaces and tabs
+inline void blanks(const char *&p, const char *end) {
+    while (p < end && (*p == ' ' || *p == '\t')) {
+        p++;
+    }
+}
+
+// read the field at p, up to end, leaving p after it and its blanks; a
+// quoted field with doubled quotes inside is unquoted into a string kept in
+// spare. returns the problem, or NULL
+const char *field(const char *&p, const char *end, IdDictionary::View &view,
+                  std::deque<std::string> &spare) {
+    
+    blanks(p, end);
+    if (p < end && *p == '"') {
+        const char *begin = ++p;
+        bool doubled = false;
+        for (;;) {
+            p = static_cast<const char *>(memchr(p, '"', end - p));
+            if (p == NULL) {
+                return "unterminated quoted field";
+            }
+            if (p + 1 < end && p[1] == '"') {
+                doubled = true;
+                p += 2;
+                continue;
+            }
+            break;
+        }
+        view = IdDictionary::View(begin, p - begin);
+        if (doubled) {
+            spare.push_back(std::string());
+            for (const char *q = begin; q < p; q++) {
+                spare.back().push_back(*q);
+                if (*q == '"') {
+                    q++;
+                }
+            }
+            view = IdDictionary::View(spare.back().data(), spare.back().size());
+        }
+        p++;
+    }
+    else {
+        const char *begin = p;
+        while (p < end && *p != ',') {
+            p++;
+        }
+        const char *last = p;
+        while (last > begin && (last[-1] == ' ' || last[-1] == '\t' ||
+                                last[-1] == '\r')) {
+            last--;
+        }
+        view = IdDictionary::View(begin, last - begin);
+    }
+    blanks(p, end);
+    return view.second == 0 ? "empty id" : NULL;
+}
+
+// parse an unsigned integer at p, leaving p after it and its blanks
+const char *number(const char *&p, const char *end, unsigned long &value) {
+    
+    blanks(p, end);
+    const char *start = p;
+    unsigned long v = 0;
+    while (p < end && (unsigned char)(*p - '0') < 10) {
+        unsigned long digit = *p - '0';
+        if (v > (ULONG_MAX - digit)/10) {
+            return "time overflows an unsigned long";
+        }
+        v = 10*v + digit;
+        p++;
+    }
+    if (p == start) {
+        return "time is not an unsigned integer";
+    }
+    value = v;
+    blanks(p, end);
+    return NULL;
+}
+
+// read the lines of a file of id,time (timed) or id,id pairs into views
+// and times; the first line of a timed file is skipped if it is a header,
+// while first says whether the first pair read is that of the first line,
+// so that the caller can tell whether that of an id,id file is a header
+bool scan(const MappedFile &map, bool timed, bool &first,
+          std::vector<IdDictionary::View> &views,
+          std::vector<unsigned long> &times, std::deque<std::string> &spare,
+          std::vector<CSVError> &errors, unsigned long &nerrors,
+          unsigned long maxerrors) {
+    
+    const char *p = map.data();
+    const char *end = p + map.size();
+    unsigned long line = 0;
+    
+    while (p < end) {
+        
+        const char *eol = static_cast<const char *>(memchr(p, '\n', end - p));
+        if (eol == NULL) {
+            eol = end;
+        }
+        line++;
+        
+        const char *q = p;
+        p = eol + 1;
+        blanks(q, eol);
+        if (q == eol || (*q == '\r' && q + 1 == eol)) {
+            continue; // blank line
+        }
+        IdDictionary::View a;
+        IdDictionary::View b;
+        unsigned long time = 0;
+        bool named = false;
+        const char *message = field(q, eol, a, spare);
+        if (message == NULL && (q == eol || *q != ',')) {
+            message = "expected a comma after the first value";
+        }
+        if (message == NULL) {
+            q++;
+            if (timed) {
+                message = number(q, eol, time);
+                
+                // the second value is not empty and starts with something
+                // other than a digit, as a column name would
+                named = message != NULL && q < eol && *q != '\r' &&
+                        (unsigned char)(*q - '0') >= 10;
+            }
+            else {
+                message = field(q, eol, b, spare);
+            }
+            if (message == NULL && q < eol && *q == '\r') {
+                q++;
+            }
+            if (message == NULL && q != eol) {
+                message = "unexpected characters after the second value";
+            }
+        }
+        
+        // a vertex file whose first line has an id and a comma but a name in
+        // place of the time starts with a header; any other bad first line
+        // is an error like any other
+        if (timed && line == 1 && named && nerrors == 0) {
+            continue;
+        }
+        
+        if (message == NULL) {
+            if (views.empty()) {
+                first = line == 1;
+            }
+            views.push_back(a);
+            if (timed) {
+                times.push_back(time);
+            }
+            else {
+                views.push_back(b);
+            }
+        }
+        else {
+            if (errors.size() < maxerrors) {
+                CSVError error;
+                error.line = line;
+                error.message = message;
+                errors.push_back(error);
+            }
+            nerrors++;
+        }
+    }
+    
+    EDGRAPH_STATS_ADD(STATS_BYTESPARSED, map.size());
+    EDGRAPH_STATS_ADD(STATS_PAIRSPARSED, timed ? views.size() : views.size()/2);
+    
+    return nerrors == 0;
+}
+
+}
+
+IdDictionary::IdDictionary() : offsets_(1, 0) {}
+
+// number the ids in the arena in their hash table
+void IdDictionary::index() {
+    
+    unsigned long n = offsets_.size() - 1;
+    unsigned long size = 16;
+    while (size < 2*n) {
+        size *= 2;
+    }
+    slots_.assign(size, 0);
+    
+    for (unsigned long k = 0; k < n; k++) {
+        unsigned long s = hash(&arena_[0] + offsets_[k], offsets_[k + 1] - offsets_[k]) &
+                          (size - 1);
+        while (slots_[s] != 0) {
+            s = (s + 1) & (size - 1);
+        }
+        slots_[s] = k + 1;
+    }
+}
+
+// number the given ids
+void IdDictionary::assign(std::vector<View> &ids) {
+    
+    std::sort( ids.begin(), ids.end(), before );
+    ids.erase( std::unique( ids.begin(), ids.end(), same ), ids.end() );
+    
+    unsigned long bytes = 0;
+    for (unsigned long k = 0; k < ids.size(); k++) {
+        bytes += ids[k].second;
+    }
+    
+    arena_.clear();
+    arena_.reserve(bytes);
+    offsets_.assign(1, 0);
+    offsets_.reserve(ids.size() + 1);
+    for (unsigned long k = 0; k < ids.size(); k++) {
+        arena_.insert(arena_.end(), ids[k].first, ids[k].first + ids[k].second);
+        offsets_.push_back(arena_.size());
+    }
+    
+    IdDictionary::index();
+}
+
+// number of ids
+unsigned long IdDictionary::size() const {
+    return offsets_.size() - 1;
+}
+
+// look up the number of an id
+bool IdDictionary::find(const char *id, unsigned long length,
+                        unsigned long &number) const {
+    
+    if (slots_.empty()) {
+        return false;
+    }
+    unsigned long mask = slots_.size() - 1;
+    for (unsigned long s = hash(id, length) & mask; slots_[s] != 0;
+         s = (s + 1) & mask) {
+        unsigned long k = slots_[s] - 1;
+        if (offsets_[k + 1] - offsets_[k] == length &&
+            memcmp(&arena_[0] + offsets_[k], id, length) == 0) {
+            number = k;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool IdDictionary::find(const std::string &id, unsigned long &number) const {
+    return IdDictionary::find(id.data(), id.size(), number);
+}
+
+// the id of a number
+std::string IdDictionary::id(unsigned long number) const {
+    return std::string(&arena_[0] + offsets_[number],
+                       offsets_[number + 1] - offsets_[number]);
+}
+
+// append the id of a number to text as a csv field
+void IdDictionary::append(std::string &text, unsigned long number) const {
+    
+    const char *id = &arena_[0] + offsets_[number];
+    unsigned long length = offsets_[number + 1] - offsets_[number];
+    
+    bool quote = false;
+    for (unsigned long k = 0; k < length && !quote; k++) {
+        quote = id[k] == ',' || id[k] == '"' || id[k] == ' ' || id[k] == '\t' ||
+                id[k] == '\r' || id[k] == '\n';
+    }
+    if (!quote) {
+        text.append(id, length);
+        return;
+    }
+    text.push_back('"');
+    for (unsigned long k = 0; k < length; k++) {
+        if (id[k] == '"') {
+            text.push_back('"');
+        }
+        text.push_back(id[k]);
+    }
+    text.push_back('"');
+}
+
+// write the dictionary to a file
+bool IdDictionary::save(const std::string &file) const {
+    
+    std::ofstream out(file.c_str(), std::ios_base::out|std::ios_base::binary);
+    if (!out.is_open()) {
+        return false;
+    }
+    
+    uint64_t n = IdDictionary::size();
+    uint64_t bytes = arena_.size();
+    out.write(idsmagic, sizeof(idsmagic));
+    out.write(reinterpret_cast<const char *>(&n), sizeof(n));
+    out.write(reinterpret_cast<const char *>(&bytes), sizeof(bytes));
+    for (unsigned long k = 0; k < offsets_.size(); k++) {
+        uint64_t offset = offsets_[k];
+        out.write(reinterpret_cast<const char *>(&offset), sizeof(offset));
+    }
+    if (bytes > 0) {
+        out.write(&arena_[0], bytes);
+    }
+    out.close();
+    return !out.fail();
+}
+
+// read a dictionary written by save()
+bool IdDictionary::open(const std::string &file) {
+    
+    std::ifstream in(file.c_str(), std::ios_base::in|std::ios_base::binary);
+    char magic[sizeof(idsmagic)];
+    uint64_t n;
+    uint64_t bytes;
+    if (!in.read(magic, sizeof(magic)) ||
+        memcmp(magic, idsmagic, sizeof(idsmagic)) != 0 ||
+        !in.read(reinterpret_cast<char *>(&n), sizeof(n)) ||
+        !in.read(reinterpret_cast<char *>(&bytes), sizeof(bytes))) {
+        return false;
+    }
+    
+    std::vector<uint64_t> offsets(n + 1);
+    std::vector<char> arena(bytes);
+    if (!in.read(reinterpret_cast<char *>(&offsets[0]), (n + 1)*sizeof(uint64_t)) ||
+        (bytes > 0 && !in.read(&arena[0], bytes)) ||
+        offsets[0] != 0 || offsets[n] != bytes) {
+        return false;
+    }
+    for (uint64_t k = 0; k < n; k++) {
+        if (offsets[k + 1] < offsets[k]) {
+            return false;
+        }
+    }
+    
+    arena_.swap(arena);
+    offsets_.assign(offsets.begin(), offsets.end());
+    IdDictionary::index();
+    return true;
+}
+
+// read csv files of vertex-id,time and vertex-id,vertex-id pairs whose ids
+// are strings
+bool readidcsv(const std::string &vertexfile, const std::string &edgefile,
+               IdDictionary &dictionary,
+               std::vector<std::pair<unsigned long, unsigned long> > &vertices,
+               std::vector<std::pair<unsigned long, unsigned long> > &edges,
+               std::string &file, std::vector<CSVError> &errors,
+               unsigned long &nerrors, unsigned long maxerrors) {
+    
+    EDGRAPH_STATS_TIMER(STATS_PARSE);
+    
+    vertices.clear();
+    edges.clear();
+    errors.clear();
+    nerrors = 0;
+    
+    // the views point into the mapped files, or into spare for ids that had
+    // to be unquoted, until the ids are numbered
+    MappedFile vertexmap;
+    MappedFile edgemap;
+    std::vector<IdDictionary::View> vertexviews;
+    std::vector<IdDictionary::View> edgeviews;
+    std::vector<unsigned long> times;
+    std::deque<std::string> spare;
+    bool first = false;
+    
+    file = vertexfile;
+    if (!vertexmap.open(vertexfile) ||
+        !scan(vertexmap, true, first, vertexviews, times, spare, errors,
+              nerrors, maxerrors)) {
+        return false;
+    }
+    first = false;
+    file = edgefile;
+    if (!edgemap.open(edgefile) ||
+        !scan(edgemap, false, first, edgeviews, times, spare, errors,
+              nerrors, maxerrors)) {
+        return false;
+    }
+    
+    // any id,id line looks like a header, so the first line of the edge file
+    // is taken for one if the citing id on it is not that of a vertex: such
+    // a vertex has no time and is never counted as citing, so no measure can
+    // depend on the line
+    if (first) {
+        bool vertex = false;
+        for (unsigned long k = 0; k < vertexviews.size() && !vertex; k++) {
+            vertex = same(vertexviews[k], edgeviews[0]);
+        }
+        if (!vertex) {
+            edgeviews.erase(edgeviews.begin(), edgeviews.begin() + 2);
+        }
+    }
+    
+    std::vector<IdDictionary::View> ids(vertexviews);
+    ids.insert(ids.end(), edgeviews.begin(), edgeviews.end());
+    dictionary.assign(ids);
+    std::vector<IdDictionary::View>().swap(ids);
+    
+    // every id was numbered, so every look up succeeds
+    unsigned long a = 0;
+    unsigned long b = 0;
+    vertices.reserve(vertexviews.size());
+    for (unsigned long k = 0; k < vertexviews.size(); k++) {
+        dictionary.find(vertexviews[k].first, vertexviews[k].second, a);
+        vertices.push_back(std::pair<unsigned long, unsigned long>(a, times[k]));
+    }
+    edges.reserve(edgeviews.size()/2);
+    for (unsigned long k = 0; k + 1 < edgeviews.size(); k += 2) {
+        dictionary.find(edgeviews[k].first, edgeviews[k].second, a);
+        dictionary.find(edgeviews[k + 1].first, edgeviews[k + 1].second, b);
+        edges.push_back(std::pair<unsigned long, unsigned long>(a, b));
+    }
+    return true;
+}
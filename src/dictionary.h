@@ -0,0 +1,122 @@
+//-----------------------------------------------------------------------------
+// File        : dictionary.h
+// Description : Numbers vertex ids that are strings, e.g. DOIs
+//-----------------------------------------------------------------------------
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the University of Michigan nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL RUSSELL J. FUNK OR JASON OWEN-SMITH BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+// Author    : Russell J. Funk
+// Email     : funk@umich.edu
+// Web page  : http://www-personal.umich.edu/~funk/index.html
+// Location  : University of Michigan, Ann Arbor, Michigan
+// Date      : December 15, 2012
+// Reference : http://arxiv.org/abs/1212.3559 (pp. 6-8 and pp. 24-25)
+//-----------------------------------------------------------------------------
+
+#ifndef _DICTIONARY_H
+#define _DICTIONARY_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "csv.h"
+
+// dictionary of vertex ids that are strings, such as DOIs or publication
+// numbers with kind codes, which gives each id a number from 0 to size() - 1
+// in the byte order of the ids. the graph is built on the numbers, so that
+// ids are only looked up where they come in (csv files, requests) and go out
+// (results, responses), and all else runs on dense indices as it does for
+// numeric ids. the ids are stored end to end in one arena, and found through
+// an open-addressing hash table of their numbers, so that looking one up
+// takes a hash and usually a single comparison
+class IdDictionary {
+    
+private:
+    
+    // id k is arena_[offsets_[k] .. offsets_[k + 1] - 1]
+    std::vector<char> arena_;
+    std::vector<unsigned long> offsets_;
+    
+    // number + 1 of the id hashed to each slot, or 0 for an empty slot; the
+    // number of slots is a power of two at least twice the number of ids
+    std::vector<unsigned long> slots_;
+    
+    // number the ids in the arena in their hash table
+    void index();
+    
+public:
+    
+    // an id to be added: its first byte and its length
+    typedef std::pair<const char *, unsigned long> View;
+    
+    IdDictionary();
+    
+    // number the given ids, in which repeats are allowed, replacing any ids
+    // numbered before; ids is sorted in the process
+    void assign(std::vector<View> &ids);
+    
+    // number of ids
+    unsigned long size() const;
+    
+    // look up the number of an id; false if it is not in the dictionary
+    bool find(const char *id, unsigned long length, unsigned long &number) const;
+    bool find(const std::string &id, unsigned long &number) const;
+    
+    // the id of a number
+    std::string id(unsigned long number) const;
+    
+    // append the id of a number to text as a csv field, i.e., in double
+    // quotes (doubled inside) if it holds a comma, quote or white space
+    void append(std::string &text, unsigned long number) const;
+    
+    // write the dictionary to a file, e.g. next to the snapshot of its graph,
+    // or read one written by save(); both return false if the file cannot be
+    // written or read
+    bool save(const std::string &file) const;
+    bool open(const std::string &file);
+    
+};
+
+// read csv files of vertex-id,time and vertex-id,vertex-id pairs whose ids
+// are strings: every id found in either file is numbered by dictionary, and
+// vertices and edges get the (number, time) and (number, number) pairs that
+// EDGraphT is built from, in file order. a field may be quoted, and must be
+// if it holds a comma or quote; blanks around fields are dropped. blank
+// lines are skipped, as is a header line at the start of either file: in
+// the vertex file, a first line with an id and a comma whose time does not
+// start with a digit (any other malformed first line is an error), and in
+// the edge file, a first line whose citing id is not in the vertex file,
+// which, being without a time, could not count towards any measure.
+// returns false if a file cannot be opened or has malformed lines, with the
+// file in file and the lines as in readcsv()
+bool readidcsv(const std::string &vertexfile, const std::string &edgefile,
+               IdDictionary &dictionary,
+               std::vector<std::pair<unsigned long, unsigned long> > &vertices,
+               std::vector<std::pair<unsigned long, unsigned long> > &edges,
+               std::string &file, std::vector<CSVError> &errors,
+               unsigned long &nerrors, unsigned long maxerrors = 10);
+
+#endif
@@ -37,245 +37,1386 @@
 //-----------------------------------------------------------------------------
 
 #include <algorithm>
+#include <climits>
 #include <cstdlib>
-#include <fstream>
 #include <iostream>
-#include <map>
-#include <sstream>
+#include <limits>
 #include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
+#include "csv.h"
 #include "edgraph_v1.h"
+#include "stats.h"
 
-// defines edgraph (evolving directed graph) class
-EDGraph::EDGraph(std::string vertexfile, std::string edgefile) {
+// time returned for vertices that appear in the edge list only
+template <typename Index, typename Time>
+const unsigned long EDGraphT<Index, Time>::notime = ULONG_MAX;
+
+// and the time stored for them
+template <typename Index, typename Time>
+const Time EDGraphT<Index, Time>::notime_ = std::numeric_limits<Time>::max();
+
+// read a csv file of vertex-id,time or vertex-id,vertex-id pairs, reporting
+// any problems and exiting if the file cannot be read
+static void load(const std::string &file, unsigned int threads,
+                 std::vector<std::pair<unsigned long, unsigned long> > &pairs) {
+    
+    EDGRAPH_STATS_TIMER(STATS_PARSE);
+    
+    std::vector<CSVError> errors;
+    unsigned long nerrors;
     
-    // look for vertexfile and load vertices
+    if (!readcsv(file, threads, pairs, errors, nerrors)) {
+        if (nerrors == 0) {
+            std::cout << "could not open the file '" << file << "'" << std::endl;
+        }
+        for (std::vector<CSVError>::const_iterator it1 = errors.begin();
+             it1 != errors.end(); ++it1) {
+            std::cout << file << ":" << it1->line << ": " << it1->message << std::endl;
+        }
+        if (nerrors > errors.size()) {
+            std::cout << file << ": " << nerrors - errors.size();
+            std::cout << " more malformed lines" << std::endl;
+        }
+        exit(EXIT_FAILURE);
+    }
+}
+
+// defines edgraph (evolving directed graph) class
+template <typename Index, typename Time>
+EDGraphT<Index, Time>::EDGraphT(std::string vertexfile, std::string edgefile,
+                                unsigned int threads)
+    : compressed_(false), cache_(NULL), graph_(CiterCache::newgraph()) {
     
-    // TODO: transform this to a "read vertices" function that can load vertices
-    //       from generic sources, e.g., SQL, Python
+    // TODO: add "read vertices" and "read edges" functions that can load from
+    //       generic sources, e.g., SQL, Python
     
-    gvertex_ = new std::map<unsigned long, unsigned long>;
+    // look for vertexfile and load comma-separated vertex-id,time pairs
+    std::vector<std::pair<unsigned long, unsigned long> > vertices;
     
     vertexfile_ = vertexfile;
+    load(vertexfile_, threads, vertices);
+    
+    // look for edgefile and load comma-separated vertex-id,vertex-id pairs
+    std::vector<std::pair<unsigned long, unsigned long> > edges;
     
-    std::string line;
-    std::ifstream vfin;
+    edgefile_ = edgefile;
+    load(edgefile_, threads, edges);
     
-    // try to open the file
-    vfin.open(vertexfile_.c_str(), std::ios_base::in|std::ios_base::binary);
-    if (!vfin.is_open()) {
-        std::cout << "could not open the file '" << vertexfile_ << "'" << std::endl;
+    // convert to the compressed sparse row representation
+    EDGraphT::build(vertices, edges);
+}
+
+// edgraph built from (id, time) and (citing, cited) pairs
+template <typename Index, typename Time>
+EDGraphT<Index, Time>::EDGraphT(
+    const std::vector<std::pair<unsigned long, unsigned long> > &vertices,
+    const std::vector<std::pair<unsigned long, unsigned long> > &edges)
+    : compressed_(false), cache_(NULL), graph_(CiterCache::newgraph()) {
+    EDGraphT::build(vertices, edges);
+}
+
+// builds the dense index and both adjacency directions
+template <typename Index, typename Time>
+void EDGraphT<Index, Time>::build(
+    const std::vector<std::pair<unsigned long, unsigned long> > &vertices,
+    const std::vector<std::pair<unsigned long, unsigned long> > &edges) {
+    
+    EDGRAPH_STATS_TIMER(STATS_BUILD);
+    
+    // collect every vertex id mentioned in either file; the dense index of a
+    // vertex is its position in the sorted, unique list of ids
+    std::vector<unsigned long> ids;
+    ids.reserve(vertices.size() + 2*edges.size());
+    for (std::vector<std::pair<unsigned long, unsigned long> >::const_iterator it1 =
+         vertices.begin(); it1 != vertices.end(); ++it1) {
+        ids.push_back(it1->first);
+    }
+    for (std::vector<std::pair<unsigned long, unsigned long> >::const_iterator it1 =
+         edges.begin(); it1 != edges.end(); ++it1) {
+        ids.push_back(it1->first);
+        ids.push_back(it1->second);
+    }
+    std::sort( ids.begin(), ids.end() ); // keep unique ids only
+    ids.erase( std::unique( ids.begin(), ids.end() ), ids.end() );
+    std::vector<unsigned long>(ids).swap(ids); // release the excess capacity
+    
+    unsigned long n = ids.size();
+    
+    // every dense index has to fit the index type
+    if (n > 0 && n - 1 > (unsigned long)std::numeric_limits<Index>::max()) {
+        std::cout << "the graph has " << n << " vertices, too many for its";
+        std::cout << " index type" << std::endl;
         exit(EXIT_FAILURE);
     }
     
-    // parses the file and extracts comma-separated vertex-id,time pairs
-    while (getline(vfin, line)) {
-        std::istringstream linestream(line);
-        std::string item;
-        
-        unsigned long vertex;
-        unsigned long time;
-        
-        getline(linestream, item, ',');
-        vertex = atoi(item.c_str());
-        getline(linestream, item);
-        time = atoi(item.c_str());
-        
-        gvertex_->insert(std::pair<unsigned long, unsigned long>(vertex, time));
+    // assign times; as with std::map::insert, the first occurrence of a vertex
+    // in the vertex file wins
+    std::vector<Time> times(n, notime_);
+    std::vector<bool> seen(n, false);
+    for (std::vector<std::pair<unsigned long, unsigned long> >::const_iterator it1 =
+         vertices.begin(); it1 != vertices.end(); ++it1) {
+        unsigned long i = std::lower_bound(ids.begin(), ids.end(), it1->first)
+                          - ids.begin();
+        if (!seen[i]) {
+            if (it1->second >= (unsigned long)notime_) {
+                std::cout << "the time " << it1->second << " of vertex ";
+                std::cout << it1->first << " does not fit the time type of";
+                std::cout << " the graph" << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            times[i] = (Time)it1->second;
+            seen[i] = true;
+        }
     }
     
-    // close the vertex file
-    vfin.close();
+    // translate edges to dense indices
+    std::vector<unsigned long> from(edges.size());
+    std::vector<unsigned long> to(edges.size());
+    for (unsigned long e = 0; e < edges.size(); e++) {
+        from[e] = std::lower_bound(ids.begin(), ids.end(), edges[e].first)
+                  - ids.begin();
+        to[e] = std::lower_bound(ids.begin(), ids.end(), edges[e].second)
+                - ids.begin();
+    }
     
+    // counting sort into both directions; edges of the same vertex keep their
+    // order in the edge file, just as they did in the multimaps
+    std::vector<unsigned long> citedoffsets(n + 1, 0);
+    std::vector<unsigned long> citingoffsets(n + 1, 0);
+    for (unsigned long e = 0; e < edges.size(); e++) {
+        citedoffsets[from[e] + 1]++;
+        citingoffsets[to[e] + 1]++;
+    }
+    for (unsigned long i = 0; i < n; i++) {
+        citedoffsets[i + 1] += citedoffsets[i];
+        citingoffsets[i + 1] += citingoffsets[i];
+    }
     
-    // look for edgefile and load edges
+    std::vector<Index> cited(edges.size());
+    std::vector<Index> citing(edges.size());
+    std::vector<unsigned long> citedpos(citedoffsets.begin(), citedoffsets.end() - 1);
+    std::vector<unsigned long> citingpos(citingoffsets.begin(), citingoffsets.end() - 1);
+    for (unsigned long e = 0; e < edges.size(); e++) {
+        cited[citedpos[from[e]]++] = (Index)to[e];
+        citing[citingpos[to[e]]++] = (Index)from[e];
+    }
     
-    // TODO: transform this to a "read edges" function that can load edges from
-    //       generic sources, e.g., SQL, Python
+    // order the citations received by each vertex by citing time, so that
+    // time windows are contiguous
+    std::vector<std::pair<unsigned long, unsigned long> > timed;
+    for (unsigned long i = 0; i < n; i++) {
+        timed.clear();
+        for (unsigned long e = citingoffsets[i]; e < citingoffsets[i + 1]; e++) {
+            timed.push_back(std::pair<unsigned long, unsigned long>(times[citing[e]],
+                                                                    citing[e]));
+        }
+        std::sort( timed.begin(), timed.end() );
+        for (unsigned long e = citingoffsets[i]; e < citingoffsets[i + 1]; e++) {
+            citing[e] = timed[e - citingoffsets[i]].second;
+        }
+    }
     
+    std::vector<Time> citingtimes(edges.size());
+    for (unsigned long e = 0; e < edges.size(); e++) {
+        citingtimes[e] = times[citing[e]];
+    }
     
-    gcited_ = new std::multimap<unsigned long, unsigned long>;
-    gciting_ = new std::multimap<unsigned long, unsigned long>;
+    ids_.assign(ids);
+    times_.assign(times);
+    citedoffsets_.assign(citedoffsets);
+    cited_.assign(cited);
+    citingoffsets_.assign(citingoffsets);
+    citing_.assign(citing);
+    citingtimes_.assign(citingtimes);
+}
+
+// add the vertices and edges of another pair of csv files to the graph
+template <typename Index, typename Time>
+void EDGraphT<Index, Time>::append(std::string vertexfile, std::string edgefile,
+                                   unsigned int threads,
+                                   std::vector<unsigned long> &affected) {
     
-    edgefile_ = edgefile;
+    std::vector<std::pair<unsigned long, unsigned long> > vertices;
+    load(vertexfile, threads, vertices);
+    
+    std::vector<std::pair<unsigned long, unsigned long> > edges;
+    load(edgefile, threads, edges);
+    
+    EDGraphT::append(vertices, edges, affected);
+}
+
+// add vertices and edges to the graph
+template <typename Index, typename Time>
+void EDGraphT<Index, Time>::append(
+    const std::vector<std::pair<unsigned long, unsigned long> > &newvertices,
+    const std::vector<std::pair<unsigned long, unsigned long> > &newedges,
+    std::vector<unsigned long> &affected) {
     
-    // obtain citing and cited multimaps
-    std::ifstream efin;
+    EDGRAPH_STATS_TIMER(STATS_APPEND);
     
-    // try to open the file
-    efin.open(edgefile_.c_str(), std::ios_base::in|std::ios_base::binary);
-    if (!efin.is_open()) {
-        std::cout << "could not open the file '" << edgefile_ << "'" << std::endl;
+    // the graph is rebuilt from the plain arrays
+    if (compressed_) {
+        std::cout << "a compressed graph cannot be appended to" << std::endl;
         exit(EXIT_FAILURE);
     }
     
-    // parses the file and extracts comma-separated vertex-id,vertex-id pairs
-    while (getline(efin, line)) {
-        std::istringstream linestream(line);
-        std::string item;
-        
-        unsigned long vertexa;
-        unsigned long vertexb;
-        
-        getline(linestream, item, ',');
-        vertexa = atoi(item.c_str());
-        getline(linestream, item);
-        vertexb = atoi(item.c_str());
-        
-        gcited_->insert(std::pair<unsigned long, unsigned long>(vertexa, vertexb));
-        gciting_->insert(std::pair<unsigned long, unsigned long>(vertexb, vertexa));
+    // cached citers may have changed, so the graph keys its entries anew
+    graph_ = CiterCache::newgraph();
+    
+    // vertices that get their first time; the citations they make start
+    // counting, just like new edges
+    std::vector<unsigned long> timed;
+    for (std::vector<std::pair<unsigned long, unsigned long> >::const_iterator it1 =
+         newvertices.begin(); it1 != newvertices.end(); ++it1) {
+        unsigned long i;
+        if (!EDGraphT::index(it1->first, i) || times_[i] == notime_) {
+            timed.push_back(it1->first);
+        }
+    }
+    
+    // the graph so far followed by the new vertices and edges; since build()
+    // keeps the first time of a vertex and the order of the citations made
+    // by each vertex, this is the graph of the old and new files together
+    std::vector<std::pair<unsigned long, unsigned long> > vertices;
+    std::vector<std::pair<unsigned long, unsigned long> > edges;
+    vertices.reserve(ids_.size() + newvertices.size());
+    edges.reserve(cited_.size() + newedges.size());
+    
+    for (unsigned long i = 0; i < ids_.size(); i++) {
+        if (times_[i] != notime_) {
+            vertices.push_back(std::pair<unsigned long, unsigned long>(ids_[i],
+                                                                       times_[i]));
+        }
+        for (unsigned long e = citedoffsets_[i]; e < citedoffsets_[i + 1]; e++) {
+            edges.push_back(std::pair<unsigned long, unsigned long>(ids_[i],
+                                                                    ids_[cited_[e]]));
+        }
+    }
+    vertices.insert(vertices.end(), newvertices.begin(), newvertices.end());
+    edges.insert(edges.end(), newedges.begin(), newedges.end());
+    
+    EDGraphT::build(vertices, edges);
+    
+    // the arrays are no longer those of a snapshot
+    snapshot_.close();
+    
+    // a new edge from c to p changes the neighborhood of c (a new
+    // predecessor), of p (a new citer) and of every other vertex citing p
+    // before c (a new citer of a predecessor); an edge from a vertex without
+    // a time changes nothing, as that vertex never counts as a citer
+    std::vector<bool> marked(ids_.size(), false);
+    unsigned long c = 0;
+    unsigned long p = 0;
+    
+    for (std::vector<std::pair<unsigned long, unsigned long> >::const_iterator it1 =
+         newedges.begin(); it1 != newedges.end(); ++it1) {
+        EDGraphT::index(it1->first, c);
+        EDGraphT::index(it1->second, p);
+        if (times_[c] == notime_) {
+            continue;
+        }
+        marked[c] = true;
+        marked[p] = true;
+        unsigned long end = EDGraphT::citingbegin(p, times_[c]);
+        for (unsigned long e = citingoffsets_[p]; e < end; e++) {
+            marked[citing_[e]] = true;
+        }
+    }
+    
+    // the same goes for every edge from a vertex with a new time
+    for (std::vector<unsigned long>::const_iterator it1 = timed.begin();
+         it1 != timed.end(); ++it1) {
+        EDGraphT::index(*it1, c);
+        marked[c] = true;
+        for (unsigned long e1 = citedoffsets_[c]; e1 < citedoffsets_[c + 1]; e1++) {
+            p = cited_[e1];
+            marked[p] = true;
+            unsigned long end = EDGraphT::citingbegin(p, times_[c]);
+            for (unsigned long e2 = citingoffsets_[p]; e2 < end; e2++) {
+                marked[citing_[e2]] = true;
+            }
+        }
+    }
+    
+    affected.clear();
+    for (unsigned long i = 0; i < ids_.size(); i++) {
+        if (marked[i]) {
+            affected.push_back(ids_[i]);
+        }
+    }
+}
+
+// look up the dense index of a vertex id
+template <typename Index, typename Time>
+bool EDGraphT<Index, Time>::index(unsigned long focalvertex,
+                                  unsigned long &i) const {
+    const unsigned long *it1 = std::lower_bound(ids_.begin(), ids_.end(),
+                                                focalvertex);
+    if (it1 == ids_.end() || *it1 != focalvertex) {
+        return false;
+    }
+    i = it1 - ids_.begin();
+    return true;
+}
+
+// store the adjacency lists compressed
+template <typename Index, typename Time>
+void EDGraphT<Index, Time>::compress() {
+    
+    if (compressed_) {
+        return;
+    }
+    
+    unsigned long n = ids_.size();
+    packedcited_.assign(cited_.begin(), citedoffsets_.begin(), n);
+    packedciting_.assign(citing_.begin(), citingoffsets_.begin(), n);
+    packedcitingtimes_.assign(citingtimes_.begin(), citingoffsets_.begin(), n);
+    cited_.refer(NULL, 0);
+    citing_.refer(NULL, 0);
+    citingtimes_.refer(NULL, 0);
+    compressed_ = true;
+}
+
+// whether the adjacency lists are compressed
+template <typename Index, typename Time>
+bool EDGraphT<Index, Time>::compressed() const {
+    return compressed_;
+}
+
+// return the memory taken by the adjacency lists and their offsets
+template <typename Index, typename Time>
+unsigned long EDGraphT<Index, Time>::adjacencybytes() const {
+    unsigned long bytes = (citedoffsets_.size() + citingoffsets_.size())*
+                          sizeof(unsigned long);
+    if (compressed_) {
+        return bytes + packedcited_.bytes() + packedciting_.bytes() +
+               packedcitingtimes_.bytes();
+    }
+    return bytes + (cited_.size() + citing_.size())*sizeof(Index) +
+           citingtimes_.size()*sizeof(Time);
+}
+
+// return the end of the citations to vertex i made at or before endtime
+template <typename Index, typename Time>
+unsigned long EDGraphT<Index, Time>::citingend(unsigned long i,
+                                               unsigned long endtime) const {
+    
+    // no citation with a known time is made at or after notime_, so later end
+    // times (including notime, the time of the edge-only vertices) take in
+    // all of them
+    Time end = endtime < notime_ ? (Time)endtime : (Time)(notime_ - 1);
+    
+    if (compressed_) {
+        return packedcitingtimes_.partition(citingoffsets_[i], citingoffsets_[i],
+                                            citingoffsets_[i + 1],
+                                            [&](Time t) { return t <= end; });
     }
     
-    // close the edge file
-    efin.close();
+    return std::upper_bound(citingtimes_.begin() + citingoffsets_[i],
+                            citingtimes_.begin() + citingoffsets_[i + 1],
+                            end) - citingtimes_.begin();
+}
+
+// return the position of the first citation to vertex i made at or after
+// starttime
+template <typename Index, typename Time>
+unsigned long EDGraphT<Index, Time>::citingbegin(unsigned long i,
+                                                 unsigned long starttime) const {
+    
+    // times at or beyond notime_ cannot be stored; every citation with a
+    // known time comes before them
+    if (starttime >= notime_) {
+        return EDGraphT::citingend(i, notime);
+    }
+    
+    if (compressed_) {
+        Time start = (Time)starttime;
+        return packedcitingtimes_.partition(citingoffsets_[i], citingoffsets_[i],
+                                            citingoffsets_[i + 1],
+                                            [&](Time t) { return t < start; });
+    }
+    
+    return std::lower_bound(citingtimes_.begin() + citingoffsets_[i],
+                            citingtimes_.begin() + citingoffsets_[i + 1],
+                            (Time)starttime) - citingtimes_.begin();
 }
 
 // return time associated with particular vertex
-unsigned long EDGraph::time(unsigned long focalvertex) {
-    unsigned long time = gvertex_->find(focalvertex)->second;
-    return time;
+template <typename Index, typename Time>
+unsigned long EDGraphT<Index, Time>::time(unsigned long focalvertex) const {
+    unsigned long i;
+    if (!EDGraphT::index(focalvertex, i)) {
+        return notime;
+    }
+    if (times_[i] == notime_) {
+        return notime;
+    }
+    return times_[i];
 }
 
 
 // return all vertices from the vertex list
-std::vector<unsigned long> EDGraph::vertices(){
+template <typename Index, typename Time>
+std::vector<unsigned long> EDGraphT<Index, Time>::vertices() const {
     
     std::vector<unsigned long> vertices;
     
-    for (std::map<unsigned long,unsigned long>::iterator it1 = gvertex_->begin();
-         it1 != gvertex_->end(); ++it1) {
-        vertices.push_back(it1->first);
+    for (unsigned long i = 0; i < ids_.size(); i++) {
+        if (times_[i] != notime_) {
+            vertices.push_back(ids_[i]);
+        }
     }
     return vertices;
 }
 
 // return citations made by a particular vertex (backward in time)
-std::vector<unsigned long> EDGraph::cited(unsigned long focalvertex){
-    
-    std::pair<std::multimap<unsigned long,unsigned long>::iterator,
-    std::multimap<unsigned long,unsigned long>::iterator> it1;
-    
-    it1 = gcited_->equal_range(focalvertex);
+template <typename Index, typename Time>
+std::vector<unsigned long> EDGraphT<Index, Time>::cited(unsigned long focalvertex) const {
     std::vector<unsigned long> cited;
-    
-    for (std::multimap<unsigned long,unsigned long>::iterator it2 = it1.first;
-         it2 != it1.second; ++it2) {
-        cited.push_back((*it2).second);
-    }
+    EDGraphT::cited(focalvertex, cited);
     return cited;
 }
 
-// return citations to a particular vertex (forward in time)
-std::vector<unsigned long> EDGraph::citing(unsigned long focalvertex,
-                                           unsigned long endtime) {
+// return citations made by a particular vertex into a caller's buffer
+template <typename Index, typename Time>
+void EDGraphT<Index, Time>::cited(unsigned long focalvertex,
+                                  std::vector<unsigned long> &cited) const {
     
-    std::pair<std::multimap<unsigned long,unsigned long>::iterator,
-    std::multimap<unsigned long,unsigned long>::iterator> it1;
+    cited.clear();
     
-    it1 = gciting_->equal_range(focalvertex);
+    unsigned long i;
+    if (!EDGraphT::index(focalvertex, i)) {
+        return;
+    }
+    
+    EDGraphT::forcited(i, [&](unsigned long, unsigned long b) {
+        cited.push_back(ids_[b]);
+    });
+}
+
+// return citations to a particular vertex (forward in time)
+template <typename Index, typename Time>
+std::vector<unsigned long> EDGraphT<Index, Time>::citing(unsigned long focalvertex,
+                                                         unsigned long endtime) const {
     std::vector<unsigned long> citing;
+    EDGraphT::citing(focalvertex, endtime, citing);
+    return citing;
+}
+
+// return citations to a particular vertex into a caller's buffer
+template <typename Index, typename Time>
+void EDGraphT<Index, Time>::citing(unsigned long focalvertex, unsigned long endtime,
+                                   std::vector<unsigned long> &citing) const {
     
-    for (std::multimap<unsigned long,unsigned long>::iterator it2 = it1.first;
-         it2 != it1.second; ++it2) {
-        
-        if (EDGraph::time((*it2).second) <= endtime) {
-            citing.push_back((*it2).second);
-        }
+    citing.clear();
+    
+    unsigned long i;
+    if (!EDGraphT::index(focalvertex, i)) {
+        return;
     }
-    return citing;
+    
+    // citations are sorted by time, so those up to endtime form a prefix
+    unsigned long end = EDGraphT::citingend(i, endtime);
+    
+    EDGraphT::forciting(i, citingoffsets_[i], end,
+                        [&](unsigned long c, unsigned long) {
+                            citing.push_back(ids_[c]);
+                        });
 }
 
 // return the out-degree of a particular vertex (does not vary with time)
-unsigned long EDGraph::outdegree(unsigned long focalvertex){
-    return gcited_->count(focalvertex);
+template <typename Index, typename Time>
+unsigned long EDGraphT<Index, Time>::outdegree(unsigned long focalvertex) const {
+    unsigned long i;
+    if (!EDGraphT::index(focalvertex, i)) {
+        return 0;
+    }
+    return citedoffsets_[i + 1] - citedoffsets_[i];
 }
 
 // return the in-degree of a particular vertex
-unsigned long EDGraph::indegree(unsigned long focalvertex,
-                                unsigned long endtime){
-    return EDGraph::citing(focalvertex, endtime).size();
+template <typename Index, typename Time>
+unsigned long EDGraphT<Index, Time>::indegree(unsigned long focalvertex,
+                                              unsigned long endtime) const {
+    unsigned long i;
+    if (!EDGraphT::index(focalvertex, i)) {
+        return 0;
+    }
+    return EDGraphT::citingend(i, endtime) - citingoffsets_[i];
+}
+
+// return the metrics that follow from the given counts
+Metrics tally(unsigned long fonly, unsigned long both, unsigned long bonly,
+              unsigned long indegree) {
+    
+    Metrics m;
+    
+    m.n_i = fonly + both + bonly;
+    m.fonly = fonly;
+    m.both = both;
+    m.bonly = bonly;
+    m.indegree = indegree;
+    
+    // calculate final measure; vertices citing the focal vertex only count 1,
+    // those citing both it and its predecessors count -1
+    m.disrupt = ((double)fonly - (double)both)/(double)m.n_i;
+    m.radical = m.disrupt*m.indegree;
+    
+    return m;
+}
+
+// marks left on a vertex by neighborhood(), on top of the stamp of the call:
+// the vertex cites the focal vertex, a predecessor, or (both bits) both
+static const unsigned int MARKF = 1;
+static const unsigned int MARKB = 2;
+static const unsigned int MARKSTEP = 4;
+
+// move the marks to a new stamp; a vertex has been seen in a call if its
+// mark is at least the stamp of the call, so moving to a new stamp clears all
+// of the marks at once, and they only need resetting when the stamps run out
+unsigned int Workspace::newstamp(unsigned long n) {
+    if (marks_.size() != n || stamp_ > UINT_MAX - 2*MARKSTEP) {
+        marks_.assign(n, 0);
+        stamp_ = 0;
+    }
+    stamp_ += MARKSTEP;
+    return stamp_;
+}
+
+// classify the vertices in the given ranges of the citations to vertex i and
+// to its predecessors
+template <typename Index, typename Time>
+template <typename Range, typename Cites>
+void EDGraphT<Index, Time>::classify(unsigned long i, unsigned long begin,
+                                     unsigned long end, Range range,
+                                     Cites cites, Workspace &workspace) const {
+    
+    std::vector<unsigned int> &marks = workspace.marks_;
+    std::vector<std::pair<unsigned long, unsigned long> > &citers = workspace.citers_;
+    
+    citers.clear();
+    
+    unsigned int stamp = workspace.newstamp(ids_.size());
+    
+#ifdef EDGRAPH_STATS
+    uint64_t scanned = end > begin ? end - begin : 0;
+    uint64_t listed = citingoffsets_[i + 1] - citingoffsets_[i];
+#endif
+    
+    // mark all forward citations to focal vertex
+    EDGraphT::forciting(i, begin, end, [&](unsigned long citer, unsigned long time) {
+        if (marks[citer] < stamp) {
+            marks[citer] = stamp | MARKF;
+            citers.push_back(std::pair<unsigned long, unsigned long>(time, citer));
+        }
+    });
+    
+    // mark all forward citations of the backward citations made by the focal
+    // vertex, adding those not seen before
+    EDGraphT::forcited(i, [&](unsigned long e1, unsigned long b) {
+        range(e1, b, begin, end);
+#ifdef EDGRAPH_STATS
+        scanned += end > begin ? end - begin : 0;
+        listed += citingoffsets_[b + 1] - citingoffsets_[b];
+#endif
+        EDGraphT::forciting(b, begin, end, [&](unsigned long citer, unsigned long time) {
+            unsigned int mark = marks[citer];
+            if (mark < stamp) {
+                marks[citer] = stamp | MARKB;
+                citers.push_back(std::pair<unsigned long, unsigned long>(time, citer));
+            }
+            else {
+                marks[citer] = mark | MARKB;
+            }
+        });
+    });
+    
+#ifdef EDGRAPH_STATS
+    EDGRAPH_STATS_ADD(STATS_EDGESSCANNED, scanned);
+    EDGRAPH_STATS_ADD(STATS_CITERSFILTERED, listed - scanned);
+    EDGRAPH_STATS_NEIGHBORHOOD(ids_[i], citers.size(), scanned);
+#endif
+    
+    // each vertex was added once; classify it by its marks
+    for (std::vector<std::pair<unsigned long, unsigned long> >::iterator it1 =
+         citers.begin(); it1 != citers.end(); ++it1) {
+        unsigned int mark = marks[it1->second] & (MARKF | MARKB);
+        if (cites(it1->second)) {
+            mark |= MARKB;
+        }
+        if (mark == MARKF) {
+            it1->second = FONLY;
+        }
+        else if (mark == MARKB) {
+            it1->second = BONLY;
+        }
+        else {
+            it1->second = BOTH;
+        }
+    }
+    
+    // NOTE: pathways can be counted using
+    //       double pathcount = i.size()*b.size()*2;
+}
+
+// collect the (time, kind) of every vertex following vertex i that cites it
+// and/or its predecessors at or before endtime
+template <typename Index, typename Time>
+void EDGraphT<Index, Time>::neighborhood(unsigned long i, unsigned long endtime,
+                                         Workspace &workspace) const {
+    
+    // citations are sorted by time, so the vertices following the focal
+    // vertex up to endtime are a contiguous range of each list
+    unsigned long focaltime = times_[i];
+    
+    EDGraphT::classify(i, EDGraphT::citingend(i, focaltime),
+                       EDGraphT::citingend(i, endtime),
+                       [&](unsigned long, unsigned long b, unsigned long &begin,
+                           unsigned long &end) {
+                           begin = EDGraphT::citingend(b, focaltime);
+                           end = EDGraphT::citingend(b, endtime);
+                       },
+                       [](unsigned long) { return false; },
+                       workspace);
+}
+
+// predecessors with at least this many citations may be shared in a batch
+// (see metrics_batch)
+static const unsigned long SHAREDCITATIONS = 64;
+
+// workspace of the calling thread, for the overloads that are not given one
+static Workspace &localworkspace() {
+    static thread_local Workspace workspace;
+    return workspace;
 }
 
 // return normalized disruptiveness (Funk & Owen-Smith, 2012: pp. 6-8;
 // see http://arxiv.org/abs/1212.3559 for download)
-double EDGraph::disrupt(unsigned long focalvertex, unsigned long endtime) {
+template <typename Index, typename Time>
+double EDGraphT<Index, Time>::disrupt(unsigned long focalvertex,
+                                      unsigned long endtime) const {
+    return EDGraphT::metrics(focalvertex, endtime, localworkspace()).disrupt;
+}
+
+template <typename Index, typename Time>
+double EDGraphT<Index, Time>::disrupt(unsigned long focalvertex,
+                                      unsigned long endtime,
+                                      Workspace &workspace) const {
+    return EDGraphT::metrics(focalvertex, endtime, workspace).disrupt;
+}
+
+// return disruptiveness, radicalness and in-degree, along with the counts
+// behind them
+template <typename Index, typename Time>
+Metrics EDGraphT<Index, Time>::metrics(unsigned long focalvertex,
+                                       unsigned long endtime) const {
+    return EDGraphT::metrics(focalvertex, endtime, localworkspace());
+}
+
+template <typename Index, typename Time>
+Metrics EDGraphT<Index, Time>::metrics(unsigned long focalvertex,
+                                       unsigned long endtime,
+                                       Workspace &workspace) const {
     
-    // collect all forward citations to focal vertex
-    std::vector<unsigned long> f_i = EDGraph::citing(focalvertex, endtime);
+    // all of the work is done on dense indices, which sort in the same order
+    // as the vertex ids they stand for
+    unsigned long focal;
+    if (!EDGraphT::index(focalvertex, focal)) {
+        return tally(0, 0, 0, 0);
+    }
     
-    // collect all backward citations made by focal vertex
-    std::vector<unsigned long> b = EDGraph::cited(focalvertex);
+    if (cache_ != NULL) {
+        return EDGraphT::cached(focal, endtime, workspace);
+    }
     
-    // collect all unique forward citations of the backward citations made by the
-    // focal vertex
-    std::vector<unsigned long> b_i;
+    EDGraphT::neighborhood(focal, endtime, workspace);
+    
+    return EDGraphT::counted(focal, endtime, workspace);
+}
+
+// use a cache of the citers of heavily cited predecessors
+template <typename Index, typename Time>
+void EDGraphT<Index, Time>::cache(CiterCache *cache) {
+    cache_ = cache;
+}
+
+// return the distinct citers of vertex b up to position end of its citations
+template <typename Index, typename Time>
+std::shared_ptr<const typename CiterCacheT<Index>::Entry>
+EDGraphT<Index, Time>::citers(unsigned long b, unsigned long end) const {
     
-    for (std::vector<unsigned long>::iterator it1 = b.begin(); it1 != b.end();
-         ++it1) {
-        std::vector<unsigned long> vb_i = EDGraph::citing(*it1, endtime);
-        b_i.insert( b_i.end(), vb_i.begin(), vb_i.end() );
+    std::shared_ptr<const typename CiterCache::Entry> entry =
+        cache_->find(graph_, b, end);
+    if (entry) {
+        return entry;
     }
-    std::sort( b_i.begin(), b_i.end() ); // keep unique elements b_i only
-    b_i.erase( std::unique( b_i.begin(), b_i.end() ), b_i.end() );
     
-    // create vector i of all forward citations to the focal vertex and/or its
-    // backward citations
-    std::vector<unsigned long> i;
+    std::shared_ptr<typename CiterCache::Entry> added(new typename CiterCache::Entry);
+    unsigned long offset = citingoffsets_[b];
+    added->citers.reserve(end - offset);
+    EDGraphT::forciting(b, offset, end, [&](unsigned long c, unsigned long) {
+        added->citers.push_back((Index)c);
+    });
+    std::sort( added->citers.begin(), added->citers.end() );
+    added->citers.erase( std::unique( added->citers.begin(), added->citers.end() ),
+                         added->citers.end() );
     
-    i.reserve( f_i.size() + b_i.size() ); // preallocate memory
-    i.insert( i.end(), f_i.begin(), f_i.end() ); // add f_i
-    i.insert( i.end(), b_i.begin(), b_i.end() ); // add b_i
+    // a bit per vertex is smaller for the most cited vertices, and finds a
+    // citer without searching
+    unsigned long distinct = added->citers.size();
+    unsigned long words = (ids_.size() + 63)/64;
+    if (words*sizeof(uint64_t) < distinct*sizeof(Index)) {
+        added->bits.assign(words, 0);
+        for (unsigned long k = 0; k < added->citers.size(); k++) {
+            added->bits[added->citers[k] >> 6] |= (uint64_t)1 << (added->citers[k] & 63);
+        }
+        std::vector<Index>().swap(added->citers);
+    }
     
-    std::sort( i.begin(), i.end() ); // keep unique elements of i only
-    i.erase( std::unique( i.begin(), i.end() ), i.end() );
+    // repeated citations by one vertex are next to each other, having the
+    // same time
+    if (distinct < end - offset) {
+        added->repeats.reserve(end - offset + 1);
+        added->repeats.push_back(0);
+        unsigned long previous = ULONG_MAX;
+        EDGraphT::forciting(b, offset, end, [&](unsigned long c, unsigned long) {
+            added->repeats.push_back(added->repeats.back() + (c == previous ? 1 : 0));
+            previous = c;
+        });
+    }
     
-    // calculate numerator (raw disruptiveness)
-    std::vector<double> d_raw;
+    return cache_->insert(graph_, b, end, added);
+}
+
+// return the metrics of vertex i at endtime using the cache
+template <typename Index, typename Time>
+Metrics EDGraphT<Index, Time>::cached(unsigned long i, unsigned long endtime,
+                                      Workspace &workspace) const {
     
-    // sort f_i for binary search
-    std::sort (f_i.begin(), f_i.end());
+    // the predecessor with the most citations following vertex i
+    unsigned long focaltime = times_[i];
+    unsigned long hub = 0;
+    unsigned long hubbegin = 0;
+    unsigned long hubend = 0;
+    EDGraphT::forcited(i, [&](unsigned long, unsigned long b) {
+        unsigned long begin = EDGraphT::citingend(b, focaltime);
+        unsigned long end = EDGraphT::citingend(b, endtime);
+        if (end > begin && end - begin > hubend - hubbegin) {
+            hub = b;
+            hubbegin = begin;
+            hubend = end;
+        }
+    });
     
-    // sort b_i for binary search
-    std::sort (b_i.begin(), b_i.end());
+    if (hubend - hubbegin < cache_->threshold() || hubend == hubbegin) {
+        EDGraphT::neighborhood(i, endtime, workspace);
+        return EDGraphT::counted(i, endtime, workspace);
+    }
     
-    // iterate over all i's
+    std::shared_ptr<const typename CiterCache::Entry> entry =
+        EDGraphT::citers(hub, hubend);
+    // the vertices citing vertex i and its other predecessors, each checked
+    // for citing the hub
+    unsigned long inside = 0;
+    EDGraphT::classify(i, EDGraphT::citingend(i, focaltime),
+                       EDGraphT::citingend(i, endtime),
+                       [&](unsigned long, unsigned long b, unsigned long &begin,
+                           unsigned long &end) {
+                           if (b == hub) {
+                               begin = end = 0;
+                           }
+                           else {
+                               begin = EDGraphT::citingend(b, focaltime);
+                               end = EDGraphT::citingend(b, endtime);
+                           }
+                       },
+                       [&](unsigned long vertex) {
+                           if (entry->contains(vertex)) {
+                               inside++;
+                               return true;
+                           }
+                           return false;
+                       },
+                       workspace);
     
-    double n_i = 0.0;
+    // the distinct citers of the hub following vertex i that were not found
+    // cite its predecessors only
+    unsigned long distinct = hubend - hubbegin;
+    if (!entry->repeats.empty()) {
+        unsigned long offset = citingoffsets_[hub];
+        distinct -= entry->repeats[hubend - offset] -
+                    entry->repeats[hubbegin - offset + 1];
+    }
+    
+    Metrics m = EDGraphT::counted(i, endtime, workspace);
+    return tally(m.fonly, m.both, m.bonly + distinct - inside, m.indegree);
+}
+
+// return the metrics of vertex i from the neighborhood in the workspace
+template <typename Index, typename Time>
+Metrics EDGraphT<Index, Time>::counted(unsigned long i, unsigned long endtime,
+                                       const Workspace &workspace) const {
+    
+    unsigned long counts[3] = {0, 0, 0};
+    for (std::vector<std::pair<unsigned long, unsigned long> >::const_iterator it1 =
+         workspace.citers_.begin(); it1 != workspace.citers_.end(); ++it1) {
+        counts[it1->second]++;
+    }
+    
+    return tally(counts[FONLY], counts[BOTH], counts[BONLY],
+                 EDGraphT::citingend(i, endtime) - citingoffsets_[i]);
+}
+
+// return the disruptiveness of many vertices at one end time
+template <typename Index, typename Time>
+std::vector<double>
+EDGraphT<Index, Time>::disrupt_batch(const std::vector<unsigned long> &focalvertices,
+                                     unsigned long endtime) const {
+    
+    std::vector<Metrics> metrics;
+    EDGraphT::metrics_batch(focalvertices, endtime, metrics, localworkspace());
     
-    unsigned long focaltime = EDGraph::time(focalvertex);
-    for (std::vector<unsigned long>::iterator it1 = i.begin(); it1 != i.end();
-         ++it1) {
+    std::vector<double> disrupt(metrics.size());
+    for (unsigned long k = 0; k < metrics.size(); k++) {
+        disrupt[k] = metrics[k].disrupt;
+    }
+    return disrupt;
+}
+
+// return the metrics of many vertices at one end time
+template <typename Index, typename Time>
+std::vector<Metrics>
+EDGraphT<Index, Time>::metrics_batch(const std::vector<unsigned long> &focalvertices,
+                                     unsigned long endtime) const {
+    std::vector<Metrics> metrics;
+    EDGraphT::metrics_batch(focalvertices, endtime, metrics, localworkspace());
+    return metrics;
+}
+
+template <typename Index, typename Time>
+void EDGraphT<Index, Time>::metrics_batch(const std::vector<unsigned long> &focalvertices,
+                                          unsigned long endtime,
+                                          std::vector<Metrics> &metrics,
+                                          Workspace &workspace) const {
+    
+    std::vector<std::pair<unsigned long, unsigned long> > &focals = workspace.focals_;
+    std::vector<unsigned long> &hubs = workspace.hubs_;
+    std::vector<unsigned long> &hubrepeats = workspace.hubrepeats_;
+    std::vector<unsigned long> &repeats = workspace.repeats_;
+    std::vector<std::pair<unsigned long, unsigned long> > &ranges = workspace.ranges_;
+    
+    metrics.resize(focalvertices.size());
+    
+    // vertices not in the graph have no neighborhood; the others are
+    // processed in order of dense index, so that repeats are adjacent
+    focals.clear();
+    for (unsigned long k = 0; k < focalvertices.size(); k++) {
+        unsigned long i;
+        if (EDGraphT::index(focalvertices[k], i)) {
+            focals.push_back(std::pair<unsigned long, unsigned long>(i, k));
+        }
+        else {
+            metrics[k] = tally(0, 0, 0, 0);
+        }
+    }
+    std::sort( focals.begin(), focals.end() );
+    
+    // predecessors of the batch with many citations (hubs) can be shared:
+    // rather than marking the citers of a hub again for every focal vertex
+    // that cites it, the vertices in its time-filtered range are counted all
+    // at once, and only the vertices collected from the other lists are
+    // checked for citing it. counting has to skip duplicate edges, which are
+    // adjacent in the time-sorted lists, so the first time a hub is met in
+    // the batch, the running count of duplicates along its citations is
+    // appended to repeats, starting at hubrepeats[j] for hub j
+    hubs.clear();
+    hubrepeats.clear();
+    repeats.clear();
+    
+    for (unsigned long k = 0; k < focals.size(); k++) {
+        unsigned long i = focals[k].first;
+        
+        // a repeated vertex gets the same metrics
+        if (k > 0 && focals[k - 1].first == i) {
+            metrics[focals[k].second] = metrics[focals[k - 1].second];
+            continue;
+        }
+        
+        unsigned long focaltime = times_[i];
+        unsigned long begin = EDGraphT::citingend(i, focaltime);
+        unsigned long end = EDGraphT::citingend(i, endtime);
+        
+        // the ranges of the predecessors, and the longest one of a hub
+        ranges.clear();
+        unsigned long total = end > begin ? end - begin : 0;
+        unsigned long shared = ULONG_MAX;
+        unsigned long sharedlength = 0;
+        unsigned long sharedrepeats = 0;
+        EDGraphT::forcited(i, [&](unsigned long e, unsigned long b) {
+            std::pair<unsigned long, unsigned long> range(EDGraphT::citingend(b, focaltime),
+                                                          EDGraphT::citingend(b, endtime));
+            unsigned long length = range.second > range.first ?
+                                   range.second - range.first : 0;
+            if (length > sharedlength && length >= SHAREDCITATIONS) {
+                unsigned long j = std::lower_bound(hubs.begin(), hubs.end(), b)
+                                  - hubs.begin();
+                if (j == hubs.size() || hubs[j] != b) {
+                    hubs.insert(hubs.begin() + j, b);
+                    hubrepeats.insert(hubrepeats.begin() + j, repeats.size());
+                    unsigned long count = 0;
+                    unsigned long previous = ULONG_MAX;
+                    EDGraphT::forciting(b, citingoffsets_[b], citingoffsets_[b + 1],
+                                        [&](unsigned long c, unsigned long) {
+                        count += c == previous;
+                        repeats.push_back(count);
+                        previous = c;
+                    });
+                }
+                shared = e;
+                sharedlength = length;
+                sharedrepeats = hubrepeats[j];
+            }
+            total += length;
+            ranges.push_back(range);
+        });
         
-        // calculate n_i with only those vertexs following focal vertex
-        if (EDGraph::time(*it1) > focaltime){
-            n_i++;
+        // sharing pays off when the hub's range is most of the work: every
+        // vertex collected otherwise is then checked against the hub, which
+        // costs a few times as much as marking a vertex
+        if (sharedlength <= 4*(total - sharedlength)) {
+            shared = ULONG_MAX;
+        }
+        unsigned long hub = 0;
+        unsigned long hubvertices = 0;
+        unsigned long inhub = 0;
+        if (shared != ULONG_MAX) {
+            hub = EDGraphT::citedat(i, shared);
+            const std::pair<unsigned long, unsigned long> &range =
+                ranges[shared - citedoffsets_[i]];
+            const unsigned long *counts = &repeats[sharedrepeats] - citingoffsets_[hub];
+            hubvertices = sharedlength - (counts[range.second - 1] - counts[range.first]);
+        }
+        
+        EDGraphT::classify(i, begin, end,
+                           [&](unsigned long e, unsigned long, unsigned long &begin,
+                               unsigned long &end) {
+                               begin = ranges[e - citedoffsets_[i]].first;
+                               end = e != shared ? ranges[e - citedoffsets_[i]].second
+                                                 : begin;
+                           },
+                           [&](unsigned long c) {
+                               if (shared == ULONG_MAX) {
+                                   return false;
+                               }
+                               bool found = false;
+                               EDGraphT::forcited(c, [&](unsigned long,
+                                                         unsigned long b) {
+                                   found = found || b == hub;
+                               });
+                               inhub += found;
+                               return found;
+                           },
+                           workspace);
+        
+        Metrics m = EDGraphT::counted(i, endtime, workspace);
+        if (shared != ULONG_MAX) {
             
-            double f_fcite = std::binary_search(f_i.begin(), f_i.end(), *it1);
-            double b_fcite = std::binary_search(b_i.begin(), b_i.end(), *it1);
-            d_raw.push_back(-2.0*f_fcite*b_fcite + f_fcite);
+            // the vertices of the hub's range not collected otherwise cite a
+            // predecessor only
+            m = tally(m.fonly, m.both, m.bonly + hubvertices - inhub, m.indegree);
         }
+        metrics[focals[k].second] = m;
     }
+}
+
+// return the metrics for every end time from firsttime to lasttime
+template <typename Index, typename Time>
+std::vector<Metrics> EDGraphT<Index, Time>::disrupt_series(unsigned long focalvertex,
+                                                           unsigned long firsttime,
+                                                           unsigned long lasttime) const {
+    std::vector<Metrics> series;
+    EDGraphT::disrupt_series(focalvertex, firsttime, lasttime, series,
+                             localworkspace());
+    return series;
+}
+
+template <typename Index, typename Time>
+void EDGraphT<Index, Time>::disrupt_series(unsigned long focalvertex,
+                                           unsigned long firsttime,
+                                           unsigned long lasttime,
+                                           std::vector<Metrics> &series,
+                                           Workspace &workspace) const {
     
-    // sum elements of d_raw
-    double d_raw_sum = 0.0;
+    series.clear();
     
-    for (std::vector<double>::iterator it1 = d_raw.begin(); it1 != d_raw.end();
-         ++it1)
-        d_raw_sum += *it1;
+    if (lasttime < firsttime) {
+        return;
+    }
+    series.resize(lasttime - firsttime + 1);
     
-    // NOTE: pathways can be counted using
-    //       double pathcount = i.size()*b.size()*2;
+    // gather the neighborhood as of the last end time, in time order
+    std::vector<std::pair<unsigned long, unsigned long> > &citers = workspace.citers_;
     
-    // calculate final measure
-    double d = d_raw_sum/n_i;
+    unsigned long focal = 0;
+    bool found = EDGraphT::index(focalvertex, focal);
+    if (found) {
+        EDGraphT::neighborhood(focal, lasttime, workspace);
+        std::sort( citers.begin(), citers.end() );
+    }
+    else {
+        citers.clear();
+    }
+    
+    // sweep the end times, counting each vertex once its time is reached
+    unsigned long counts[3] = {0, 0, 0};
+    std::vector<std::pair<unsigned long, unsigned long> >::const_iterator it1 =
+        citers.begin();
     
-    return d;
+    for (unsigned long k = 0; k < series.size(); k++) {
+        unsigned long endtime = firsttime + k;
+        
+        for (; it1 != citers.end() && it1->first <= endtime; ++it1) {
+            counts[it1->second]++;
+        }
+        
+        unsigned long indegree = 0;
+        if (found) {
+            indegree = EDGraphT::citingend(focal, endtime) - citingoffsets_[focal];
+        }
+        series[k] = tally(counts[FONLY], counts[BOTH], counts[BONLY], indegree);
+    }
+}
+
+// return the time offset from time, or the largest time if out of range
+static unsigned long later(unsigned long time, unsigned long offset) {
+    return offset > ULONG_MAX - time ? ULONG_MAX : time + offset;
+}
+
+// collect the vertices that cite vertex i and/or its predecessors from
+// starttime to endtime
+template <typename Index, typename Time>
+void EDGraphT<Index, Time>::window(unsigned long i, unsigned long starttime,
+                                   unsigned long endtime,
+                                   Workspace &workspace) const {
+    
+    EDGraphT::classify(i, EDGraphT::citingbegin(i, starttime),
+                       EDGraphT::citingend(i, endtime),
+                       [&](unsigned long, unsigned long b, unsigned long &begin,
+                           unsigned long &end) {
+                           begin = EDGraphT::citingbegin(b, starttime);
+                           end = EDGraphT::citingend(b, endtime);
+                       },
+                       [](unsigned long) { return false; },
+                       workspace);
+}
+
+// return the metrics of a vertex over a window of time relative to its own
+template <typename Index, typename Time>
+Metrics EDGraphT<Index, Time>::metrics_window(unsigned long focalvertex,
+                                              unsigned long start,
+                                              unsigned long end) const {
+    return EDGraphT::metrics_window(focalvertex, start, end, localworkspace());
+}
+
+template <typename Index, typename Time>
+Metrics EDGraphT<Index, Time>::metrics_window(unsigned long focalvertex,
+                                              unsigned long start,
+                                              unsigned long end,
+                                              Workspace &workspace) const {
+    
+    unsigned long i;
+    if (!EDGraphT::index(focalvertex, i) || times_[i] == notime_) {
+        return tally(0, 0, 0, 0);
+    }
+    
+    // only vertices following the focal vertex are counted
+    unsigned long time = times_[i];
+    unsigned long endtime = later(time, end);
+    EDGraphT::window(i, later(time, std::max(start, 1UL)), endtime, workspace);
+    
+    Metrics m = EDGraphT::counted(i, endtime, workspace);
+    return tally(m.fonly, m.both, m.bonly,
+                 EDGraphT::citingend(i, endtime) -
+                 std::min(EDGraphT::citingbegin(i, later(time, start)),
+                          EDGraphT::citingend(i, endtime)));
+}
+
+// return the metrics of a vertex over several windows with the same start
+template <typename Index, typename Time>
+void EDGraphT<Index, Time>::metrics_windows(unsigned long focalvertex,
+                                            unsigned long start,
+                                            const std::vector<unsigned long> &ends,
+                                            std::vector<Metrics> &metrics,
+                                            Workspace &workspace) const {
+    
+    metrics.resize(ends.size());
+    
+    unsigned long i;
+    if (!EDGraphT::index(focalvertex, i) || times_[i] == notime_) {
+        for (unsigned long w = 0; w < ends.size(); w++) {
+            metrics[w] = tally(0, 0, 0, 0);
+        }
+        return;
+    }
+    
+    // gather the widest window, in time order
+    std::vector<std::pair<unsigned long, unsigned long> > &citers = workspace.citers_;
+    
+    unsigned long time = times_[i];
+    unsigned long widest = 0;
+    for (unsigned long w = 0; w < ends.size(); w++) {
+        widest = std::max(widest, ends[w]);
+    }
+    EDGraphT::window(i, later(time, std::max(start, 1UL)), later(time, widest),
+                     workspace);
+    std::sort( citers.begin(), citers.end() );
+    
+    // and count the part of it within each window
+    unsigned long first = EDGraphT::citingbegin(i, later(time, start));
+    for (unsigned long w = 0; w < ends.size(); w++) {
+        unsigned long endtime = later(time, ends[w]);
+        
+        unsigned long counts[3] = {0, 0, 0};
+        for (std::vector<std::pair<unsigned long, unsigned long> >::const_iterator it1 =
+             citers.begin(); it1 != citers.end() && it1->first <= endtime; ++it1) {
+            counts[it1->second]++;
+        }
+        
+        unsigned long last = EDGraphT::citingend(i, endtime);
+        metrics[w] = tally(counts[FONLY], counts[BOTH], counts[BONLY],
+                           last - std::min(first, last));
+    }
+}
+
+// return the metrics of many vertices over several windows
+template <typename Index, typename Time>
+std::vector<Metrics>
+EDGraphT<Index, Time>::metrics_windows(const std::vector<unsigned long> &focalvertices,
+                                       unsigned long start,
+                                       const std::vector<unsigned long> &ends,
+                                       unsigned int threads) const {
+    
+    std::vector<Metrics> metrics(focalvertices.size()*ends.size());
+    
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+    if (threads == 0) {
+        threads = 1;
+    }
+    
+    // the vertices are dealt out to the threads in small chunks, as their
+    // cost varies with the in-degree of their predecessors
+    const unsigned long chunk = 64;
+    std::atomic<unsigned long> position(0);
+    
+    auto work = [&]() {
+        Workspace workspace;
+        std::vector<Metrics> windows;
+        unsigned long begin;
+        while ((begin = position.fetch_add(chunk)) < focalvertices.size()) {
+            unsigned long end = std::min<unsigned long>(begin + chunk,
+                                                        focalvertices.size());
+            for (unsigned long k = begin; k < end; k++) {
+                EDGraphT::metrics_windows(focalvertices[k], start, ends, windows,
+                                          workspace);
+                std::copy(windows.begin(), windows.end(),
+                          metrics.begin() + k*ends.size());
+            }
+        }
+    };
+    
+    if (threads == 1 || focalvertices.size() <= chunk) {
+        work();
+    }
+    else {
+        std::vector<std::thread> workers;
+        for (unsigned int w = 0; w < threads; w++) {
+            workers.push_back(std::thread(work));
+        }
+        for (unsigned int w = 0; w < threads; w++) {
+            workers[w].join();
+        }
+    }
+    
+    return metrics;
+}
+
+// add vertex c to the counts of the vertices it follows and cites
+template <typename Index, typename Time>
+void EDGraphT<Index, Time>::sweepvertex(unsigned long c, Sweep &sweep,
+                                        Workspace &workspace) const {
+    
+    std::vector<unsigned int> &marks = workspace.marks_;
+    std::vector<std::pair<unsigned long, unsigned long> > &cited = workspace.citers_;
+    
+    cited.clear();
+    
+    unsigned int stamp = workspace.newstamp(ids_.size());
+    
+    EDGRAPH_STATS_ADD(STATS_SWEPT, 1);
+    
+    // vertex c counts for the vertices from firsttime_ up to (not including)
+    // its own time that it cites, either directly
+    unsigned long time = times_[c];
+    EDGraphT::forcited(c, [&](unsigned long, unsigned long f) {
+        if (times_[f] >= sweep.firsttime_ && times_[f] < time &&
+            marks[f] < stamp) {
+            marks[f] = stamp | MARKF;
+            cited.push_back(std::pair<unsigned long, unsigned long>(f, 0));
+        }
+    });
+    
+    // or by citing one of their predecessors; the vertices citing a
+    // predecessor in that time window are a contiguous range of its list
+    EDGraphT::forcited(c, [&](unsigned long, unsigned long b) {
+        unsigned long end = EDGraphT::citingbegin(b, time);
+        unsigned long begin = EDGraphT::citingbegin(b, sweep.firsttime_);
+        EDGRAPH_STATS_ADD(STATS_EDGESSCANNED, end - std::min(begin, end));
+        EDGraphT::forciting(b, begin, end, [&](unsigned long f, unsigned long) {
+            unsigned int mark = marks[f];
+            if (mark < stamp) {
+                marks[f] = stamp | MARKB;
+                cited.push_back(std::pair<unsigned long, unsigned long>(f, 0));
+            }
+            else {
+                marks[f] = mark | MARKB;
+            }
+        });
+    });
+    
+    // each vertex was added once; count c as the kind its marks say
+    for (std::vector<std::pair<unsigned long, unsigned long> >::const_iterator it1 =
+         cited.begin(); it1 != cited.end(); ++it1) {
+        unsigned int mark = marks[it1->first] & (MARKF | MARKB);
+        if (mark == MARKF) {
+            sweep.fonly_[it1->first].fetch_add(1, std::memory_order_relaxed);
+        }
+        else if (mark == MARKB) {
+            sweep.bonly_[it1->first].fetch_add(1, std::memory_order_relaxed);
+        }
+        else {
+            sweep.both_[it1->first].fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+// advance a sweep to endtime
+template <typename Index, typename Time>
+void EDGraphT<Index, Time>::sweep(Sweep &sweep, unsigned long endtime,
+                                  unsigned int threads) const {
+    
+    if (endtime < sweep.endtime_) {
+        return;
+    }
+    
+    // on first use, order the citing vertices by time and clear the counts
+    unsigned long n = ids_.size();
+    if (sweep.fonly_.size() != n) {
+        std::vector<std::pair<unsigned long, unsigned long> > timed;
+        for (unsigned long i = 0; i < n; i++) {
+            if (times_[i] != notime_ && times_[i] > sweep.firsttime_) {
+                timed.push_back(std::pair<unsigned long, unsigned long>(times_[i], i));
+            }
+        }
+        std::sort( timed.begin(), timed.end() );
+        
+        sweep.order_.resize(timed.size());
+        for (unsigned long k = 0; k < timed.size(); k++) {
+            sweep.order_[k] = timed[k].second;
+        }
+        sweep.next_ = 0;
+        
+        std::vector<std::atomic<unsigned int> > fonly(n);
+        std::vector<std::atomic<unsigned int> > both(n);
+        std::vector<std::atomic<unsigned int> > bonly(n);
+        for (unsigned long i = 0; i < n; i++) {
+            fonly[i].store(0, std::memory_order_relaxed);
+            both[i].store(0, std::memory_order_relaxed);
+            bonly[i].store(0, std::memory_order_relaxed);
+        }
+        sweep.fonly_.swap(fonly);
+        sweep.both_.swap(both);
+        sweep.bonly_.swap(bonly);
+    }
+    
+    // the vertices citing up to endtime not swept yet
+    unsigned long first = sweep.next_;
+    unsigned long last = first;
+    while (last < sweep.order_.size() && times_[sweep.order_[last]] <= endtime) {
+        last++;
+    }
+    
+    // the counts are sums, so the vertices can be added in any order; they
+    // are dealt out to the threads in small chunks, as their cost varies
+    // with the in-degree of what they cite
+    if (threads == 0) {
+        threads = 1;
+    }
+    if (sweep.workspaces_.size() < threads) {
+        sweep.workspaces_.resize(threads);
+    }
+    
+    const unsigned long chunk = 64;
+    std::atomic<unsigned long> position(first);
+    
+    auto work = [&](unsigned int w) {
+        unsigned long begin;
+        while ((begin = position.fetch_add(chunk)) < last) {
+            unsigned long end = std::min(begin + chunk, last);
+            for (unsigned long k = begin; k < end; k++) {
+                EDGraphT::sweepvertex(sweep.order_[k], sweep, sweep.workspaces_[w]);
+            }
+        }
+    };
+    
+    if (threads == 1 || last - first <= chunk) {
+        work(0);
+    }
+    else {
+        std::vector<std::thread> workers;
+        for (unsigned int w = 0; w < threads; w++) {
+            workers.push_back(std::thread(work, w));
+        }
+        for (unsigned int w = 0; w < threads; w++) {
+            workers[w].join();
+        }
+    }
+    
+    sweep.next_ = last;
+    sweep.endtime_ = endtime;
+}
+
+// return the metrics of a vertex as of the end time of a sweep
+template <typename Index, typename Time>
+Metrics EDGraphT<Index, Time>::swept(const Sweep &sweep,
+                                     unsigned long focalvertex) const {
+    
+    unsigned long i;
+    if (!EDGraphT::index(focalvertex, i)) {
+        return tally(0, 0, 0, 0);
+    }
+    
+    unsigned long indegree = EDGraphT::citingend(i, sweep.endtime_) - citingoffsets_[i];
+    if (i >= sweep.fonly_.size()) {
+        return tally(0, 0, 0, indegree);
+    }
     
+    return tally(sweep.fonly_[i].load(std::memory_order_relaxed),
+                 sweep.both_[i].load(std::memory_order_relaxed),
+                 sweep.bonly_[i].load(std::memory_order_relaxed),
+                 indegree);
 }
 
 // destructor
-EDGraph::~EDGraph(){
+template <typename Index, typename Time>
+EDGraphT<Index, Time>::~EDGraphT(){
 }
 
-// TODO: add multimap destructors (comment out)
+// the configurations compiled into the library (see edgraph_v1.h)
+template class EDGraphT<unsigned long, unsigned long>;
+template class EDGraphT<uint32_t, uint32_t>;
+template class EDGraphT<uint32_t, uint16_t>;
@@ -39,52 +39,548 @@
 #ifndef _EDGRAPH_H
 #define _EDGRAPH_H
 
-class EDGraph {
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "array.h"
+#include "citercache.h"
+#include "deltalists.h"
+#include "mappedfile.h"
+
+// disruptiveness, radicalness (in-degree weighted disruptiveness) and
+// in-degree of a vertex as of some end time, along with the counts behind
+// them; of the n_i vertices following the focal vertex that cite it and/or
+// its predecessors, fonly cite the focal vertex only, both cite the focal
+// vertex and at least one predecessor, and bonly cite predecessors only
+struct Metrics {
+    double disrupt;
+    double radical;
+    unsigned long indegree;
+    unsigned long n_i;
+    unsigned long fonly;
+    unsigned long both;
+    unsigned long bonly;
+};
+
+// metrics estimated by sampling (see EDGraphT::metrics_approx): the counts
+// that were estimated are rounded, while disrupt and radical follow from the
+// unrounded estimates. low and high bound an approximate 95% confidence
+// interval of disrupt, and samples is the number of citations sampled; if
+// approximated is false, the metrics are exact and so is the interval
+struct Estimate {
+    Metrics metrics;
+    double low;
+    double high;
+    bool approximated;
+    unsigned long samples;
+};
+
+// return the metrics that follow from the given counts; disruptiveness is
+// (fonly - both)/n_i, which is not a number when n_i is zero
+Metrics tally(unsigned long fonly, unsigned long both, unsigned long bonly,
+              unsigned long indegree);
+
+// scratch space for the metric routines of EDGraphT; once its buffers have
+// grown to fit the largest neighborhood seen, queries that are given a
+// workspace make no heap allocations. a workspace may be reused freely, but
+// only by one thread at a time; the overloads without one use a workspace
+// private to the calling thread
+class Workspace {
+    
+    template <typename Index, typename Time> friend class EDGraphT;
+    
+private:
+    
+    // one mark per vertex of the graph (4 bytes each), recording which
+    // vertices have been seen in the current query and how they cite the
+    // focal vertex; marks from earlier queries are invalidated by moving to
+    // a new stamp rather than by clearing the array
+    std::vector<unsigned int> marks_;
+    unsigned int stamp_;
+    
+    // move to a new stamp for a graph of n vertices, returning it
+    unsigned int newstamp(unsigned long n);
+    
+    // (time, kind) of the vertices following the focal vertex
+    std::vector<std::pair<unsigned long, unsigned long> > citers_;
+    
+    // for batches (see EDGraphT::metrics_batch): the (dense index, position
+    // in the batch) of the focal vertices in processing order, the hubs
+    // among their predecessors with the running counts of duplicate edges
+    // in their citations, and the ranges of the citations to the
+    // predecessors of the current focal vertex
+    std::vector<std::pair<unsigned long, unsigned long> > focals_;
+    std::vector<unsigned long> hubs_;
+    std::vector<unsigned long> hubrepeats_;
+    std::vector<unsigned long> repeats_;
+    std::vector<std::pair<unsigned long, unsigned long> > ranges_;
+    
+public:
+    
+    Workspace() : stamp_(0) {
+    }
+    
+};
+
+// state of a sweep over the vertices of a graph in time order (see
+// EDGraphT::sweep), which accumulates the counts behind the metrics of every
+// vertex at once, end time after end time. only citing vertices after
+// firsttime are swept, so the counts are those of metrics() for vertices
+// with a time of firsttime or later
+class Sweep {
+    
+    template <typename Index, typename Time> friend class EDGraphT;
+    
+private:
+    
+    // citing vertices are swept from after firsttime_; the counts are as of
+    // endtime_
+    unsigned long firsttime_;
+    unsigned long endtime_;
+    
+    // dense indices of the vertices with known times, in time order, and
+    // the position of the next one to sweep
+    std::vector<unsigned long> order_;
+    unsigned long next_;
+    
+    // counts of every vertex (see Metrics), updated concurrently by the
+    // threads of a sweep
+    std::vector<std::atomic<unsigned int> > fonly_;
+    std::vector<std::atomic<unsigned int> > both_;
+    std::vector<std::atomic<unsigned int> > bonly_;
+    
+    // one workspace per thread
+    std::vector<Workspace> workspaces_;
+    
+    // don't copy
+    Sweep(const Sweep &);
+    Sweep &operator=(const Sweep &);
+    
+public:
+    
+    explicit Sweep(unsigned long firsttime = 0)
+        : firsttime_(firsttime), endtime_(firsttime), next_(0) {
+    }
+    
+    // end time of the counts
+    unsigned long endtime() const {
+        return endtime_;
+    }
+    
+};
+
+// edgraph (evolving directed graph) type, templated on the integer types used
+// to store dense vertex indices and times; vertex ids, times and counts are
+// passed in and out as unsigned longs whatever the storage types. see the
+// typedefs below for the configurations compiled into the library
+template <typename Index, typename Time>
+class EDGraphT {
     
 private:
     
     // input vertex file name
     std::string vertexfile_;
-    std::map<unsigned long, unsigned long> *gvertex_;
     
     // input edge list file name
     std::string edgefile_;
     
-    // for storing the two columns of the edge list; this method sacrifices
-    // memory (by having two copies of the same list) for the sake of speed
-    // since both columns are sorted for fast lookups
-    std::multimap<unsigned long, unsigned long> *gcited_;
-    std::multimap<unsigned long, unsigned long> *gciting_;
+    // the graph is stored in compressed sparse row (CSR) form, built once
+    // after loading; every vertex gets a dense index, which is its position
+    // in the sorted list of vertex ids and must fit an Index
+    Array<unsigned long> ids_;
+    
+    // time associated with each vertex by dense index; vertices that only
+    // appear in the edge list have no time and are given notime, so they are
+    // never counted as citations in any time window
+    Array<Time> times_;
+    
+    // time stored for vertices that appear in the edge list only, the
+    // largest value of Time; actual times must be smaller
+    static const Time notime_;
+    
+    // the citations made by vertex i are the dense indices in
+    // cited_[citedoffsets_[i]] .. cited_[citedoffsets_[i + 1] - 1], and the
+    // citations received by vertex i are stored the same way in citing_; this
+    // method sacrifices memory (by having two copies of the same list) for
+    // the sake of speed since both directions can be read contiguously;
+    // offsets are kept as unsigned longs, so that only the number of vertices
+    // is limited by Index
+    Array<unsigned long> citedoffsets_;
+    Array<Index> cited_;
+    Array<unsigned long> citingoffsets_;
+    Array<Index> citing_;
+    
+    // the citations received by each vertex are sorted by the time of the
+    // citing vertex (ties by dense index), and citingtimes_[e] holds the time
+    // of citing_[e]; the citations to a vertex up to some end time are
+    // therefore a prefix of its list, found by binary search
+    Array<Time> citingtimes_;
+    
+    // the same lists compressed (see compress()), in which case cited_,
+    // citing_ and citingtimes_ are empty; positions in the lists are the
+    // same either way, so the offsets serve both
+    bool compressed_;
+    DeltaLists<Index> packedcited_;
+    DeltaLists<Index> packedciting_;
+    DeltaLists<Time> packedcitingtimes_;
+    
+    // snapshot the arrays refer to, if the graph was opened from one
+    MappedFile snapshot_;
+    
+    // cache of the citers of heavily cited predecessors, if one is in use,
+    // and the number that keys the entries of this graph in it (see
+    // CiterCacheT::newgraph)
+    CiterCacheT<Index> *cache_;
+    unsigned long graph_;
+    
+    // not copyable, since the arrays may refer to memory owned by the graph
+    EDGraphT(const EDGraphT &);
+    EDGraphT &operator=(const EDGraphT &);
+    
+    // builds the dense index and both adjacency directions from the vertex
+    // (id, time) and edge (citing, cited) pairs in file order; exits if the
+    // vertices or times do not fit the storage types
+    void build(const std::vector<std::pair<unsigned long, unsigned long> > &vertices,
+               const std::vector<std::pair<unsigned long, unsigned long> > &edges);
+    
+    // look up the dense index of a vertex id; returns false if the vertex is
+    // not in the graph
+    bool index(unsigned long focalvertex, unsigned long &i) const;
+    
+    // return the position one past the last citation to vertex i made at or
+    // before endtime, i.e., citations citingoffsets_[i] .. citingend(i) - 1
+    unsigned long citingend(unsigned long i, unsigned long endtime) const;
+    
+    // return the position of the first citation to vertex i made at or after
+    // starttime
+    unsigned long citingbegin(unsigned long i, unsigned long starttime) const;
+    
+    // call f(e, b) for the vertices b cited by vertex i, where e is the
+    // position of the citation, whether the lists are compressed or not
+    template <typename F>
+    void forcited(unsigned long i, F f) const {
+        unsigned long begin = citedoffsets_[i];
+        unsigned long end = citedoffsets_[i + 1];
+        if (compressed_) {
+            packedcited_.each(begin, begin, end, f);
+            return;
+        }
+        for (unsigned long e = begin; e < end; e++) {
+            f(e, (unsigned long)cited_[e]);
+        }
+    }
+    
+    // call f(c, t) for the vertices c citing vertex i at positions begin ..
+    // end - 1 of its citations, where t is the time of c
+    template <typename F>
+    void forciting(unsigned long i, unsigned long begin, unsigned long end,
+                   F f) const {
+        if (compressed_) {
+            packedciting_.each(packedcitingtimes_, citingoffsets_[i], begin, end,
+                               [&](unsigned long, unsigned long c, unsigned long t) {
+                                   f(c, t);
+                               });
+            return;
+        }
+        for (unsigned long e = begin; e < end; e++) {
+            f((unsigned long)citing_[e], (unsigned long)citingtimes_[e]);
+        }
+    }
+    
+    // the vertex cited by vertex i at position e, and the vertex citing
+    // vertex i at position e, for the few places that read single citations
+    unsigned long citedat(unsigned long i, unsigned long e) const {
+        return compressed_ ? (unsigned long)packedcited_.at(citedoffsets_[i], e) :
+                             (unsigned long)cited_[e];
+    }
+    unsigned long citingat(unsigned long i, unsigned long e) const {
+        return compressed_ ? (unsigned long)packedciting_.at(citingoffsets_[i], e) :
+                             (unsigned long)citing_[e];
+    }
+    
+    // add the vertex c to the counts of the vertices it follows and cites,
+    // directly or through a predecessor, as in neighborhood() but seen from
+    // the citing side
+    void sweepvertex(unsigned long c, Sweep &sweep, Workspace &workspace) const;
+    
+    // collect the (time, kind) of every vertex following vertex i that cites
+    // it and/or its predecessors at or before endtime, where kind is FONLY,
+    // BOTH or BONLY, in workspace.citers_; each vertex is classified in one
+    // linear pass over the citation lists using the marks of the workspace
+    void neighborhood(unsigned long i, unsigned long endtime,
+                      Workspace &workspace) const;
+    
+    // the kernel of neighborhood(): classify the vertices in [begin, end) of
+    // the citations to vertex i and in the range of the citations to each
+    // predecessor b given by range(e, b, begin, end), where e is the
+    // position of b in the citations made by vertex i; a vertex for which
+    // cites(vertex) is true also counts as citing a predecessor
+    template <typename Range, typename Cites>
+    void classify(unsigned long i, unsigned long begin, unsigned long end,
+                  Range range, Cites cites, Workspace &workspace) const;
+    
+    // return the metrics of vertex i at endtime from the neighborhood in
+    // workspace.citers_
+    Metrics counted(unsigned long i, unsigned long endtime,
+                    const Workspace &workspace) const;
+    
+    // collect the (time, kind) of every vertex that cites vertex i and/or its
+    // predecessors from starttime to endtime, as neighborhood() does from
+    // the time of vertex i
+    void window(unsigned long i, unsigned long starttime, unsigned long endtime,
+                Workspace &workspace) const;
+    
+    // return the metrics of vertex i at endtime, looking up the citers of
+    // its most cited predecessor in cache_ rather than marking them, if it
+    // has enough citations following vertex i
+    Metrics cached(unsigned long i, unsigned long endtime,
+                   Workspace &workspace) const;
+    
+    // return the distinct citers of vertex b up to position end of its
+    // citations, from cache_ or added to it
+    std::shared_ptr<const typename CiterCacheT<Index>::Entry>
+    citers(unsigned long b, unsigned long end) const;
+    
+    // estimate the metrics of vertex i at endtime by sampling (see
+    // approx.cpp), unless its citations and those of its predecessors
+    // following it number threshold or fewer; returns false if so
+    bool sample(unsigned long i, unsigned long endtime, unsigned long threshold,
+                double error, Estimate &estimate) const;
     
 public:
     
-    // edgraph (evolving directed graph) type
-    EDGraph(std::string vertexfile, std::string edgefile);
-    ~EDGraph();
+    // cache of the citers of heavily cited vertices for this graph type
+    typedef CiterCacheT<Index> CiterCache;
+    
+    // time returned for vertices that appear in the edge list only
+    static const unsigned long notime;
+    
+    // kinds of vertices following a focal vertex, see Metrics
+    enum { FONLY, BOTH, BONLY };
+    
+    // edgraph (evolving directed graph) type, read from csv files of
+    // vertex-id,time and citing-vertex-id,cited-vertex-id pairs on threads
+    // threads (0 = one per core); exits on unreadable or malformed files
+    EDGraphT(std::string vertexfile, std::string edgefile,
+             unsigned int threads = 0);
+    
+    // edgraph opened from a binary snapshot written by save(); the snapshot is
+    // memory-mapped and used in place, so nothing is parsed or copied and
+    // processes opening the same snapshot share one copy in memory; exits if
+    // the file is not a valid snapshot for this graph type
+    explicit EDGraphT(std::string snapshotfile);
+    
+    // edgraph built from (id, time) and (citing, cited) pairs, such as the
+    // numbers of string ids read by readidcsv() (see dictionary.h); exits if
+    // the pairs do not fit the graph type, as the constructor above does
+    EDGraphT(const std::vector<std::pair<unsigned long, unsigned long> > &vertices,
+             const std::vector<std::pair<unsigned long, unsigned long> > &edges);
+    ~EDGraphT();
+    
+    // write the graph as a binary snapshot (see snapshot.h); returns false if
+    // the file cannot be written. exits if the graph is compressed
+    bool save(const std::string &snapshotfile) const;
+    
+    // store the adjacency lists compressed (see deltalists.h) rather than as
+    // plain arrays, which are released (or, for a snapshot, no longer read).
+    // this takes some two thirds less memory for an EDGraph and a quarter to
+    // a third less for the smaller types; the metrics are the same, but the
+    // lists are decoded as they are traversed, costing some speed (see
+    // bench_suite). the graph can no longer be saved or appended to
+    void compress();
+    
+    // whether the adjacency lists are compressed
+    bool compressed() const;
+    
+    // return the memory taken by the adjacency lists and their offsets, in
+    // bytes
+    unsigned long adjacencybytes() const;
+    
+    // use cache, which any number of graphs and threads may share, each
+    // graph finding only its own entries, in metrics() and disrupt(): the
+    // predecessor of a focal vertex with the most citations following it,
+    // if at least cache->threshold(), has its citers up to the end time
+    // looked up in the cache, or added to it, and every other vertex found
+    // is checked against them, rather than all of them being marked one by
+    // one. this pays off when a few hubs are cited by many focal vertices
+    // queried at the same end times. NULL stops using a cache; after
+    // append() the graph no longer finds the entries it cached before
+    void cache(CiterCache *cache);
+    
+    // write a snapshot of the graph in a pair of csv files, identical to the
+    // one the graph read from them would save, for graphs whose edges do not
+    // fit in memory: the edge file is read piece by piece and sorted on disk
+    // (see external.cpp) using about memory bytes (at least 4 megabytes)
+    // beyond some 40 bytes per vertex. the graph is then opened from the
+    // snapshot, which is used in place; memory bounds only the building, not
+    // what is later read from the snapshot. returns false, having reported
+    // it, if a file cannot be written or its sorted pieces cannot be read
+    // back; exits on unreadable or malformed input files
+    static bool buildsnapshot(std::string vertexfile, std::string edgefile,
+                              std::string snapshotfile, unsigned long memory,
+                              unsigned int threads = 0);
+    
+    // add the vertices and edges of another pair of csv files to the graph
+    // (which may have been opened from a snapshot), with the same result as
+    // if they had been read after the first ones, and return the vertices
+    // (sorted) whose metrics may have changed: for every new edge from a
+    // vertex with a time, or edge of a vertex whose time is new, the citing
+    // and cited vertices and the vertices citing the cited vertex before the
+    // citing one, as well as the vertices with new times. exits on
+    // unreadable or malformed files, or if the graph is compressed
+    void append(std::string vertexfile, std::string edgefile,
+                unsigned int threads, std::vector<unsigned long> &affected);
+    
+    // same, from (id, time) and (citing, cited) pairs
+    void append(const std::vector<std::pair<unsigned long, unsigned long> > &vertices,
+                const std::vector<std::pair<unsigned long, unsigned long> > &edges,
+                std::vector<unsigned long> &affected);
     
     // return all vertices from the vertex list
-    std::vector<unsigned long> vertices();
+    std::vector<unsigned long> vertices() const;
     
     // return citations made by a particular vertex (backward in time)
-    std::vector<unsigned long> cited(unsigned long focalvertex);
+    std::vector<unsigned long> cited(unsigned long focalvertex) const;
+    
+    // same, but into a buffer supplied by the caller, whose capacity is
+    // reused from call to call
+    void cited(unsigned long focalvertex, std::vector<unsigned long> &cited) const;
     
     // return citations to a particular vertex (forward in time)
     std::vector<unsigned long>
-    citing(unsigned long focalvertex, unsigned long endtime);
+    citing(unsigned long focalvertex, unsigned long endtime) const;
+    
+    // same, but into a buffer supplied by the caller
+    void citing(unsigned long focalvertex, unsigned long endtime,
+                std::vector<unsigned long> &citing) const;
     
     // return time associated with particular vertex
-    unsigned long time(unsigned long focalvertex);
+    unsigned long time(unsigned long focalvertex) const;
     
     // return the out-degree of a particular vertex (does not vary with time)
-    unsigned long outdegree(unsigned long focalvertex);
+    unsigned long outdegree(unsigned long focalvertex) const;
     
     // return the in-degree of a particular vertex
-    unsigned long indegree(unsigned long focalvertex, unsigned long endtime);
+    unsigned long indegree(unsigned long focalvertex, unsigned long endtime) const;
     
     // return normalized disruptiveness (Funk & Owen-Smith, 2012: pp. 6-8;
     // see http://arxiv.org/abs/1212.3559 for download)
-    double disrupt(unsigned long focalvertex, unsigned long endtime);
+    double disrupt(unsigned long focalvertex, unsigned long endtime) const;
+    double disrupt(unsigned long focalvertex, unsigned long endtime,
+                   Workspace &workspace) const;
+    
+    // return disruptiveness, radicalness and in-degree, along with the counts
+    // behind them, from a single traversal of the neighborhood
+    Metrics metrics(unsigned long focalvertex, unsigned long endtime) const;
+    Metrics metrics(unsigned long focalvertex, unsigned long endtime,
+                    Workspace &workspace) const;
+    
+    // return the disruptiveness of many vertices at one end time, in the
+    // order given (repeats included); the predecessors with many citations
+    // (hubs) are found once for the whole batch, and rather than traversing
+    // the citations to a hub for every vertex citing it, its citers are
+    // counted from the length of its time-filtered range, checking only the
+    // vertices collected from the other lists for citing it
+    std::vector<double>
+    disrupt_batch(const std::vector<unsigned long> &focalvertices,
+                  unsigned long endtime) const;
+    
+    // same, with all of the metrics
+    std::vector<Metrics>
+    metrics_batch(const std::vector<unsigned long> &focalvertices,
+                  unsigned long endtime) const;
+    
+    // same, but into a buffer supplied by the caller
+    void metrics_batch(const std::vector<unsigned long> &focalvertices,
+                       unsigned long endtime, std::vector<Metrics> &metrics,
+                       Workspace &workspace) const;
+    
+    // return the metrics for every end time from firsttime to lasttime, in
+    // order; the neighborhood of the focal vertex is gathered once and swept
+    // in time order, rather than once for every end time as repeated calls
+    // to metrics() would
+    std::vector<Metrics>
+    disrupt_series(unsigned long focalvertex, unsigned long firsttime,
+                   unsigned long lasttime) const;
+    
+    // same, but into a buffer supplied by the caller
+    void disrupt_series(unsigned long focalvertex, unsigned long firsttime,
+                        unsigned long lasttime, std::vector<Metrics> &series,
+                        Workspace &workspace) const;
+    
+    // return the metrics of a vertex over a window of time relative to its
+    // own: the vertices citing it and/or its predecessors at times from
+    // time + start to time + end, where a start below 1 is taken as 1, and
+    // the citations to it made at those times (start included). so CD5 is
+    // the window from 0 (or 1) to 5; with a start of 0, this is
+    // metrics(focalvertex, time + end), unless the vertex is cited before
+    // its own time. vertices without a time have no window
+    Metrics metrics_window(unsigned long focalvertex, unsigned long start,
+                           unsigned long end) const;
+    Metrics metrics_window(unsigned long focalvertex, unsigned long start,
+                           unsigned long end, Workspace &workspace) const;
+    
+    // return the metrics of a vertex over several windows with the same
+    // start and the given ends, in order, from a single traversal of the
+    // widest window
+    void metrics_windows(unsigned long focalvertex, unsigned long start,
+                         const std::vector<unsigned long> &ends,
+                         std::vector<Metrics> &metrics,
+                         Workspace &workspace) const;
+    
+    // same for many vertices on threads threads (0 = one per core), in the
+    // order given: the metrics of vertex k over window w are at position
+    // k*ends.size() + w
+    std::vector<Metrics>
+    metrics_windows(const std::vector<unsigned long> &focalvertices,
+                    unsigned long start, const std::vector<unsigned long> &ends,
+                    unsigned int threads = 1) const;
+    
+    // return the metrics of a vertex estimated from a sample of the vertices
+    // following it, if more than threshold citations to it and its
+    // predecessors would have to be gone through to count them exactly, and
+    // exact metrics otherwise. at least 512 citations are sampled, as the
+    // interval is too unsteady on fewer, so the metrics are also exact if
+    // there are no more citations than that, or if those to it number no
+    // more than threshold and those to its predecessors no more than 512.
+    // beyond that, citations are sampled until the confidence interval of
+    // disruptiveness is within error of the estimate (e.g. 0.01), but no
+    // more than about threshold of them, which bounds the time taken by a
+    // vertex however cited its predecessors are; lists no longer than the
+    // sample are counted exactly. the sample is seeded by the vertex and end
+    // time, so the estimate does not vary from run to run
+    Estimate metrics_approx(unsigned long focalvertex, unsigned long endtime,
+                            unsigned long threshold, double error) const;
+    Estimate metrics_approx(unsigned long focalvertex, unsigned long endtime,
+                            unsigned long threshold, double error,
+                            Workspace &workspace) const;
+    
+    // advance a sweep to endtime (end times must not decrease) on threads
+    // threads: every vertex citing at a time up to endtime not swept yet is
+    // added to the counts of the vertices it follows and cites, directly or
+    // through a predecessor. where the metric routines gather the citers of
+    // one focal vertex, a sweep goes through the two-step citation paths
+    // once for all vertices, so that a panel over many end times costs
+    // about as much as its last end time
+    void sweep(Sweep &sweep, unsigned long endtime, unsigned int threads = 1) const;
+    
+    // return the metrics of a vertex as of the end time of a sweep
+    Metrics swept(const Sweep &sweep, unsigned long focalvertex) const;
     
 };
 
+// the graph types compiled into the library: EDGraph stores dense indices and
+// times as unsigned longs; EDGraph32 stores both as 32-bit integers, which
+// suits graphs of fewer than 2^32 vertices with times such as yyyymmdd dates;
+// CompactEDGraph stores 16-bit times, e.g., years, which shrinks the
+// adjacency and time arrays the most
+typedef EDGraphT<unsigned long, unsigned long> EDGraph;
+typedef EDGraphT<uint32_t, uint32_t> EDGraph32;
+typedef EDGraphT<uint32_t, uint16_t> CompactEDGraph;
+
 #endif
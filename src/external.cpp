@@ -0,0 +1,580 @@
+//-----------------------------------------------------------------------------
+// File        : external.cpp
+// Description : Builds edgraph snapshots of graphs larger than memory
+//-----------------------------------------------------------------------------
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the University of Michigan nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL RUSSELL J. FUNK OR JASON OWEN-SMITH BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+// Author    : Russell J. Funk
+// Email     : funk@umich.edu
+// Web page  : http://www-personal.umich.edu/~funk/index.html
+// Location  : University of Michigan, Ann Arbor, Michigan
+// Date      : December 15, 2012
+// Reference : http://arxiv.org/abs/1212.3559 (pp. 6-8 and pp. 24-25)
+//-----------------------------------------------------------------------------
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <queue>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "csv.h"
+#include "edgraph_v1.h"
+#include "mappedfile.h"
+#include "snapshot.h"
+
+// a snapshot is built in the same steps as EDGraphT::build(), except that
+// the edges are never all in memory at once: the vertex ids and times, the
+// offsets and the degrees are (a few words per vertex), while the edge file
+// is read in pieces that fit the memory budget. a first pass collects the
+// ids; a second translates the edges of each piece to dense indices and
+// writes them out as two sorted runs, one by citing vertex, in file order,
+// and one by cited vertex and citing time; the runs are then merged straight
+// into the sections of the snapshot, which is written front to back, after
+// being merged into fewer, longer runs if there are too many to have open at
+// once
+
+namespace {
+
+typedef std::pair<unsigned long, unsigned long> Edge;
+
+// report the malformed lines of a piece of a csv file and exit
+void malformed(const std::string &file, const std::vector<CSVError> &errors,
+               unsigned long nerrors, unsigned long lines) {
+    
+    for (std::vector<CSVError>::const_iterator it1 = errors.begin();
+         it1 != errors.end(); ++it1) {
+        std::cout << file << ":" << it1->line + lines << ": " << it1->message << std::endl;
+    }
+    if (nerrors > errors.size()) {
+        std::cout << file << ": " << nerrors - errors.size();
+        std::cout << " more malformed lines" << std::endl;
+    }
+    exit(EXIT_FAILURE);
+}
+
+// call visit(pairs) with the pairs of each piece of about piecebytes bytes of
+// a csv file, in file order
+template <typename Visit>
+void pieces(const std::string &file, unsigned long piecebytes,
+            unsigned int threads, Visit visit) {
+    
+    MappedFile map;
+    if (!map.open(file)) {
+        std::cout << "could not open the file '" << file << "'" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    
+    std::vector<Edge> pairs;
+    std::vector<CSVError> errors;
+    unsigned long nerrors;
+    unsigned long lines = 0;
+    
+    const char *begin = map.data();
+    const char *end = map.data() + map.size();
+    while (begin < end) {
+        
+        // each piece ends at the end of a line
+        const char *stop = end;
+        if ((unsigned long)(end - begin) > piecebytes) {
+            const char *eol = static_cast<const char *>(
+                memchr(begin + piecebytes, '\n', end - begin - piecebytes));
+            stop = (eol == NULL) ? end : eol + 1;
+        }
+        
+        unsigned long piecelines;
+        if (!readcsv(begin, stop, begin == map.data(), threads, pairs, errors,
+                     nerrors, piecelines)) {
+            malformed(file, errors, nerrors, lines);
+        }
+        visit(pairs);
+        
+        lines += piecelines;
+        begin = stop;
+    }
+}
+
+// write the edges of a run, or return false
+bool writerun(const std::string &file, const std::vector<Edge> &run) {
+    std::ofstream out(file.c_str(), std::ios_base::out|std::ios_base::binary);
+    out.write(reinterpret_cast<const char *>(run.data()), run.size()*sizeof(Edge));
+    out.close();
+    return !out.fail();
+}
+
+// most runs merged at once, so that the files open at a time stay within
+// the limit of the process however many runs a large edge file makes: 64,
+// or fewer if the limit is lower, leaving some files for the snapshot, the
+// run being written and the standard streams. more runs are first merged
+// into longer ones in passes
+unsigned long runfanin() {
+    
+    unsigned long fanin = 64;
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY &&
+        limit.rlim_cur < fanin + 8) {
+        fanin = limit.rlim_cur > 10 ? limit.rlim_cur - 8 : 2;
+    }
+    return fanin;
+}
+
+// reads a run back in buffers of a given number of edges
+struct Run {
+    std::ifstream in;
+    std::vector<Edge> buffer;
+    unsigned long position;
+    
+    Run(const std::string &file, unsigned long edges)
+        : in(file.c_str(), std::ios_base::in|std::ios_base::binary),
+          buffer(edges), position(edges) {}
+    
+    // the next edge of the run, or false at its end or if it cannot be read,
+    // which failed() tells apart
+    bool next(Edge &edge) {
+        if (position == buffer.size()) {
+            if (!in.is_open() || in.eof()) {
+                return false;
+            }
+            in.read(reinterpret_cast<char *>(buffer.data()), buffer.size()*sizeof(Edge));
+            if (in.bad() || in.gcount() % sizeof(Edge) != 0) {
+                return false;
+            }
+            buffer.resize(in.gcount()/sizeof(Edge));
+            position = 0;
+            if (buffer.empty()) {
+                return false;
+            }
+        }
+        edge = buffer[position++];
+        return true;
+    }
+    
+    // whether the run could not be opened or read to its end
+    bool failed() const {
+        return !in.is_open() || in.bad() || !in.eof() ||
+               in.gcount() % sizeof(Edge) != 0;
+    }
+};
+
+// merge the runs, ordered by less, calling emit(edge) with each edge in
+// order; edges that compare equal come in run order. returns false, having
+// reported it, if a run cannot be opened or read
+template <typename Less, typename Emit>
+bool merge(const std::vector<std::string> &files, unsigned long bufferedges,
+           Less less, Emit emit) {
+    
+    std::vector<Run *> runs;
+    for (unsigned long r = 0; r < files.size(); r++) {
+        runs.push_back(new Run(files[r], bufferedges));
+    }
+    
+    // the next edge of every run, smallest on top
+    typedef std::pair<Edge, unsigned long> Head;
+    auto greater = [&](const Head &a, const Head &b) {
+        if (less(b.first, a.first)) {
+            return true;
+        }
+        if (less(a.first, b.first)) {
+            return false;
+        }
+        return a.second > b.second;
+    };
+    std::priority_queue<Head, std::vector<Head>, decltype(greater)> heads(greater);
+    
+    Edge edge;
+    for (unsigned long r = 0; r < runs.size(); r++) {
+        if (runs[r]->next(edge)) {
+            heads.push(Head(edge, r));
+        }
+    }
+    while (!heads.empty()) {
+        Head head = heads.top();
+        heads.pop();
+        emit(head.first);
+        if (runs[head.second]->next(edge)) {
+            heads.push(Head(edge, head.second));
+        }
+    }
+    
+    bool ok = true;
+    for (unsigned long r = 0; r < runs.size(); r++) {
+        if (runs[r]->failed()) {
+            std::cout << "could not read the file '" << files[r] << "'" << std::endl;
+            ok = false;
+        }
+        delete runs[r];
+    }
+    return ok;
+}
+
+// merge the runs in files, ordered by less, fanin at a time into longer runs
+// named after prefix, until no more than fanin are left; files is left
+// holding them, in the same order, and the runs merged are removed. returns
+// false, having reported it, if a run cannot be read or written
+template <typename Less>
+bool reduce(std::vector<std::string> &files, const std::string &prefix,
+            unsigned long fanin, unsigned long bufferedges, Less less) {
+    
+    unsigned long pass = 0;
+    while (files.size() > fanin) {
+        
+        std::vector<std::string> merged;
+        for (unsigned long first = 0; first < files.size(); first += fanin) {
+            
+            std::vector<std::string> group(
+                files.begin() + first,
+                files.begin() + std::min(first + fanin, (unsigned long)files.size()));
+            std::ostringstream name;
+            name << prefix << ".pass" << pass << "." << merged.size();
+            merged.push_back(name.str());
+            
+            std::ofstream out(merged.back().c_str(),
+                              std::ios_base::out|std::ios_base::binary);
+            std::vector<Edge> buffer;
+            buffer.reserve(bufferedges);
+            bool ok = merge(group, bufferedges, less, [&](const Edge &edge) {
+                buffer.push_back(edge);
+                if (buffer.size() == bufferedges) {
+                    out.write(reinterpret_cast<const char *>(buffer.data()),
+                              buffer.size()*sizeof(Edge));
+                    buffer.clear();
+                }
+            });
+            out.write(reinterpret_cast<const char *>(buffer.data()),
+                      buffer.size()*sizeof(Edge));
+            out.close();
+            if (out.fail()) {
+                std::cout << "could not write the file '" << merged.back() << "'";
+                std::cout << std::endl;
+                ok = false;
+            }
+            
+            for (unsigned long r = 0; r < group.size(); r++) {
+                std::remove(group[r].c_str());
+            }
+            if (!ok) {
+                files.erase(files.begin(), files.begin() + first + group.size());
+                files.insert(files.begin(), merged.begin(), merged.end());
+                return false;
+            }
+        }
+        files.swap(merged);
+        pass++;
+    }
+    return true;
+}
+
+// writes the sections of a snapshot front to back, through a buffer
+class SectionWriter {
+    
+private:
+    
+    std::ofstream out_;
+    uint64_t written_;
+    std::string buffer_;
+    
+public:
+    
+    explicit SectionWriter(const std::string &file)
+        : out_(file.c_str(), std::ios_base::out|std::ios_base::binary),
+          written_(0) {}
+    
+    bool is_open() const {
+        return out_.is_open();
+    }
+    
+    // append the bytes of value
+    template <typename T>
+    void put(T value) {
+        buffer_.append(reinterpret_cast<const char *>(&value), sizeof(value));
+        written_ += sizeof(value);
+        if (buffer_.size() >= (1 << 20)) {
+            out_.write(buffer_.data(), buffer_.size());
+            buffer_.clear();
+        }
+    }
+    
+    // pad with zeros up to offset
+    void pad(uint64_t offset) {
+        while (written_ < offset) {
+            put<char>(0);
+        }
+    }
+    
+    // write out the rest, returning false if anything failed
+    bool close() {
+        out_.write(buffer_.data(), buffer_.size());
+        buffer_.clear();
+        out_.close();
+        return !out_.fail();
+    }
+    
+};
+
+}
+
+// write a snapshot of a graph too large for memory
+template <typename Index, typename Time>
+bool EDGraphT<Index, Time>::buildsnapshot(std::string vertexfile,
+                                          std::string edgefile,
+                                          std::string snapshotfile,
+                                          unsigned long memory,
+                                          unsigned int threads) {
+    
+    // the time stored for vertices with none, as in the graph
+    const Time notime = std::numeric_limits<Time>::max();
+    
+    // a piece of the edge file takes some 12 bytes per line, then 16 as a
+    // pair and another 32 in the two runs
+    unsigned long piecebytes = std::max(memory/5, 1UL << 20);
+    
+    // the vertex file is read whole
+    std::vector<Edge> vertices;
+    std::vector<CSVError> errors;
+    unsigned long nerrors;
+    if (!readcsv(vertexfile, threads, vertices, errors, nerrors)) {
+        if (nerrors == 0) {
+            std::cout << "could not open the file '" << vertexfile << "'" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        malformed(vertexfile, errors, nerrors, 0);
+    }
+    
+    // collect every vertex id mentioned in either file, merging in those of
+    // each piece of the edge file
+    std::vector<unsigned long> ids;
+    for (std::vector<Edge>::const_iterator it1 = vertices.begin();
+         it1 != vertices.end(); ++it1) {
+        ids.push_back(it1->first);
+    }
+    std::sort( ids.begin(), ids.end() );
+    ids.erase( std::unique( ids.begin(), ids.end() ), ids.end() );
+    
+    unsigned long edges = 0;
+    std::vector<unsigned long> piece;
+    std::vector<unsigned long> merged;
+    pieces(edgefile, piecebytes, threads, [&](const std::vector<Edge> &pairs) {
+        piece.clear();
+        for (std::vector<Edge>::const_iterator it1 = pairs.begin();
+             it1 != pairs.end(); ++it1) {
+            piece.push_back(it1->first);
+            piece.push_back(it1->second);
+        }
+        std::sort( piece.begin(), piece.end() );
+        piece.erase( std::unique( piece.begin(), piece.end() ), piece.end() );
+        
+        merged.clear();
+        std::set_union(ids.begin(), ids.end(), piece.begin(), piece.end(),
+                       std::back_inserter(merged));
+        ids.swap(merged);
+        edges += pairs.size();
+    });
+    std::vector<unsigned long>().swap(piece);
+    std::vector<unsigned long>().swap(merged);
+    
+    unsigned long n = ids.size();
+    
+    // every dense index has to fit the index type
+    if (n > 0 && n - 1 > (unsigned long)std::numeric_limits<Index>::max()) {
+        std::cout << "the graph has " << n << " vertices, too many for its";
+        std::cout << " index type" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    
+    // assign times; the first occurrence of a vertex in the vertex file wins
+    std::vector<Time> times(n, notime);
+    std::vector<bool> seen(n, false);
+    for (std::vector<Edge>::const_iterator it1 = vertices.begin();
+         it1 != vertices.end(); ++it1) {
+        unsigned long i = std::lower_bound(ids.begin(), ids.end(), it1->first)
+                          - ids.begin();
+        if (!seen[i]) {
+            if (it1->second >= (unsigned long)notime) {
+                std::cout << "the time " << it1->second << " of vertex ";
+                std::cout << it1->first << " does not fit the time type of";
+                std::cout << " the graph" << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            times[i] = (Time)it1->second;
+            seen[i] = true;
+        }
+    }
+    std::vector<Edge>().swap(vertices);
+    std::vector<bool>().swap(seen);
+    
+    // translate each piece to dense indices, count the degrees, and write it
+    // out sorted by citing vertex (keeping the file order of each vertex's
+    // citations) and by cited vertex and citing time
+    std::vector<unsigned long> citedoffsets(n + 1, 0);
+    std::vector<unsigned long> citingoffsets(n + 1, 0);
+    std::vector<std::string> citedruns;
+    std::vector<std::string> citingruns;
+    bool ok = true;
+    
+    auto bycited = [&](const Edge &a, const Edge &b) {
+        if (a.first != b.first) {
+            return a.first < b.first;
+        }
+        if (times[a.second] != times[b.second]) {
+            return times[a.second] < times[b.second];
+        }
+        return a.second < b.second;
+    };
+    
+    std::vector<Edge> run;
+    pieces(edgefile, piecebytes, threads, [&](const std::vector<Edge> &pairs) {
+        std::ostringstream name;
+        name << snapshotfile << ".run" << citedruns.size();
+        
+        run.resize(pairs.size());
+        for (unsigned long e = 0; e < pairs.size(); e++) {
+            run[e].first = std::lower_bound(ids.begin(), ids.end(), pairs[e].first)
+                           - ids.begin();
+            run[e].second = std::lower_bound(ids.begin(), ids.end(), pairs[e].second)
+                            - ids.begin();
+            citedoffsets[run[e].first + 1]++;
+            citingoffsets[run[e].second + 1]++;
+        }
+        
+        std::stable_sort(run.begin(), run.end(), [](const Edge &a, const Edge &b) {
+            return a.first < b.first;
+        });
+        citedruns.push_back(name.str() + ".cited");
+        ok = writerun(citedruns.back(), run) && ok;
+        
+        // (cited, citing) pairs, by cited vertex and citing time
+        for (unsigned long e = 0; e < run.size(); e++) {
+            std::swap(run[e].first, run[e].second);
+        }
+        std::sort(run.begin(), run.end(), bycited);
+        citingruns.push_back(name.str() + ".citing");
+        ok = writerun(citingruns.back(), run) && ok;
+    });
+    std::vector<Edge>().swap(run);
+    
+    for (unsigned long i = 0; i < n; i++) {
+        citedoffsets[i + 1] += citedoffsets[i];
+        citingoffsets[i + 1] += citingoffsets[i];
+    }
+    
+    // then write the snapshot front to back, merging the runs into the
+    // sections of the edges, each run read through its share of the budget;
+    // no more than fanin runs are read at once (plus one being written while
+    // there are more), so that a share never falls below the floor of 4096
+    // edges unless the budget is below some 4 megabytes
+    SnapshotHeader header;
+    uint64_t size = snapshotheader(header, sizeof(Index), sizeof(Time), n, edges);
+    
+    unsigned long fanin = runfanin();
+    unsigned long bufferedges = std::max<unsigned long>(
+        memory/(sizeof(Edge)*(std::min<unsigned long>(citedruns.size(), fanin) + 1)),
+        1 << 12);
+    
+    ok = ok && reduce(citedruns, snapshotfile + ".cited", fanin, bufferedges,
+                      [](const Edge &a, const Edge &b) { return a.first < b.first; });
+    ok = ok && reduce(citingruns, snapshotfile + ".citing", fanin, bufferedges,
+                      bycited);
+    
+    // every edge has to come back out of the runs
+    unsigned long emitted[3] = { 0, 0, 0 };
+    
+    SectionWriter out(snapshotfile);
+    if (ok && out.is_open()) {
+        
+        out.put(header);
+        
+        out.pad(header.offsets[SNAPSHOT_IDS]);
+        for (unsigned long i = 0; i < n; i++) {
+            out.put<unsigned long>(ids[i]);
+        }
+        out.pad(header.offsets[SNAPSHOT_TIMES]);
+        for (unsigned long i = 0; i < n; i++) {
+            out.put<Time>(times[i]);
+        }
+        out.pad(header.offsets[SNAPSHOT_CITEDOFFSETS]);
+        for (unsigned long i = 0; i <= n; i++) {
+            out.put<unsigned long>(citedoffsets[i]);
+        }
+        out.pad(header.offsets[SNAPSHOT_CITED]);
+        ok = ok && merge(citedruns, bufferedges,
+                         [](const Edge &a, const Edge &b) { return a.first < b.first; },
+                         [&](const Edge &edge) {
+                             out.put<Index>((Index)edge.second);
+                             emitted[0]++;
+                         });
+        out.pad(header.offsets[SNAPSHOT_CITINGOFFSETS]);
+        for (unsigned long i = 0; i <= n; i++) {
+            out.put<unsigned long>(citingoffsets[i]);
+        }
+        out.pad(header.offsets[SNAPSHOT_CITING]);
+        ok = ok && merge(citingruns, bufferedges, bycited,
+                         [&](const Edge &edge) {
+                             out.put<Index>((Index)edge.second);
+                             emitted[1]++;
+                         });
+        out.pad(header.offsets[SNAPSHOT_CITINGTIMES]);
+        ok = ok && merge(citingruns, bufferedges, bycited,
+                         [&](const Edge &edge) {
+                             out.put<Time>(times[edge.second]);
+                             emitted[2]++;
+                         });
+        out.pad(size);
+        
+        if (ok && (emitted[0] != edges || emitted[1] != edges || emitted[2] != edges)) {
+            std::cout << "the sorted runs of the file '" << edgefile << "' came";
+            std::cout << " back incomplete" << std::endl;
+            ok = false;
+        }
+    }
+    ok = out.close() && ok;
+    
+    for (unsigned long r = 0; r < citedruns.size(); r++) {
+        std::remove(citedruns[r].c_str());
+    }
+    for (unsigned long r = 0; r < citingruns.size(); r++) {
+        std::remove(citingruns[r].c_str());
+    }
+    
+    return ok;
+}
+
+// the member above for the configurations compiled into the library
+template bool EDGraphT<unsigned long, unsigned long>::buildsnapshot(
+    std::string, std::string, std::string, unsigned long, unsigned int);
+template bool EDGraphT<uint32_t, uint32_t>::buildsnapshot(
+    std::string, std::string, std::string, unsigned long, unsigned int);
+template bool EDGraphT<uint32_t, uint16_t>::buildsnapshot(
+    std::string, std::string, std::string, unsigned long, unsigned int);
@@ -39,10 +39,18 @@
 
 // to compile and use
 
-// g++ main.cpp edgraph.cpp -o edgraph
+// g++ -std=c++11 -O2 -pthread *.cpp -o edgraph
 
-// ./edgraph vertices_time.csv edge_data_big.csv results.txt
+// ./edgraph [--threads 8] vertices_time.csv edge_data_big.csv results.txt
 
+// or, to store the graph with 32-bit indices and 16-bit years
+// ./edgraph --types compact vertices_time.csv edge_data_big.csv results.txt
+
+// or, to answer lookups on the graph from standard input (see server.h)
+// ./edgraph --serve --snapshot graph.snapshot
+
+#include <climits>
+#include <cstdio>
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
@@ -51,36 +59,104 @@
 #include <string>
 #include <vector>
 
+#include "dictionary.h"
 #include "edgraph_v1.h"
+#include "panel.h"
+#include "results.h"
+#include "server.h"
+#include "shard.h"
+#include "snapshot.h"
+#include "stats.h"
 
-int main (int argc, char* argv[])
-{
+// command line options
+struct Options {
     
     // get the vertex and edgefile from the command line
     std::string vertexfile;
     std::string edgefile;
     std::string resultsfile;
     
-    if (argc != 4) {
-        std::cout << "usage: " << argv[0];
-        std::cout << " [vertexfile] [edgefile] [resultsfile]" << std::endl;
-        exit(EXIT_FAILURE);
-    }
-    else {
-        vertexfile = argv[1];
-        edgefile = argv[2];
-        resultsfile = argv[3];
-    }
+    // snapshot to read the graph from, or to save it to
+    std::string snapshotfile;
+    std::string savefile;
+    
+    // number of threads for the panel, by default one per core
+    unsigned int threads;
+    
+    // storage types of the graph (see edgraph_v1.h): long, 32 or compact
+    std::string types;
     
-    std::cout<<"Reading vertices and edges..."<<std::endl;
+    // what the vertex ids are: numbers, or strings numbered by a dictionary
+    // (see dictionary.h) that is saved next to a snapshot
+    std::string ids;
     
-    // create a new edgraph object from files
-    EDGraph g = EDGraph(vertexfile, edgefile);
+    // how the panel is computed (see panel.h): series or sweep, or empty for
+    // series, except sweep when the snapshot is built out of core
+    std::string engine;
     
-    // some illustrative examples of the class and member functions, using three
-    // patents, PageRank (USPTO patent 6,285,999), Axel's cotransformation
-    // technique (USPTO patent 4,399,216), and Monsanto's glyphosate resistant
-    // soybeans (USPTO patent 6,958,436)
+    // vertex and edge files to append to the graph, and the results file
+    // of the graph before the append, to be updated rather than recomputed
+    std::string appendvertexfile;
+    std::string appendedgefile;
+    std::string previousfile;
+    
+    // format of the results file (see results.h): text or binary, and
+    // whether text rows are also echoed to the screen
+    std::string format;
+    bool echo;
+    
+    // whether to print where the time went (see stats.h), and a file to
+    // write the same as JSON
+    bool stats;
+    std::string statsfile;
+    
+    // memory budget in megabytes for building the snapshot of a graph too
+    // large for memory, or 0 to read the graph into memory
+    unsigned long external;
+    
+    // the shard k of shards (see shard.h) to compute, by range or hash, or
+    // 0 shards for the whole panel
+    unsigned long shard;
+    unsigned long shards;
+    std::string shardby;
+    
+    // whether to answer lookups (see server.h) rather than compute the
+    // panel, on standard input and output or on a Unix socket
+    bool serve;
+    std::string socketfile;
+    
+    // whether to keep the adjacency lists compressed once the graph is
+    // loaded (see deltalists.h), trading some speed for memory
+    bool compress;
+    
+    Options() : threads(0), types("long"), ids("number"), engine(), format("text"),
+                echo(true), stats(false), external(0), shard(0), shards(0),
+                shardby("range"), serve(false), compress(false) {}
+};
+
+// print where the time went and write it to the stats file, if asked to
+static void report(const Options &options, std::ostream &out = std::cout) {
+    
+    if (options.stats) {
+        statsreport(out);
+    }
+    if (!options.statsfile.empty()) {
+        std::ofstream stats(options.statsfile.c_str());
+        statsjson(stats);
+        stats.close();
+        if (stats.fail()) {
+            std::cout << "could not write the file '" << options.statsfile << "'" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+// some illustrative examples of the class and member functions, using three
+// patents, PageRank (USPTO patent 6,285,999), Axel's cotransformation
+// technique (USPTO patent 4,399,216), and Monsanto's glyphosate resistant
+// soybeans (USPTO patent 6,958,436)
+template <typename Graph>
+static void examples(const Graph &g) {
     
     // highly disruptive technologies (those with larger positive values on the
     // measure) interrupt the flow of citations (i.e., the use) of their
@@ -92,11 +168,12 @@ int main (int argc, char* argv[])
     // while Monsanto is highly amplifying
     
     
-    // disruptiveness of the PageRank patent in 2002, 2005, and 2010
-    double pagerank95 = g.disrupt(6285999, 1995);
-    double pagerank02 = g.disrupt(6285999, 2002);
-    double pagerank05 = g.disrupt(6285999, 2005);
-    double pagerank10 = g.disrupt(6285999, 2010);
+    // disruptiveness, radicalness and in-degree of the PageRank patent in
+    // 1995, 2002, 2005, and 2010, each from a single traversal
+    Metrics pagerank95 = g.metrics(6285999, 1995);
+    Metrics pagerank02 = g.metrics(6285999, 2002);
+    Metrics pagerank05 = g.metrics(6285999, 2005);
+    Metrics pagerank10 = g.metrics(6285999, 2010);
     
     // disruptiveness of the Axel patent in 2010
     double axel10 = g.disrupt(4399216, 2010);
@@ -128,73 +205,499 @@ int main (int argc, char* argv[])
     std::cout << "PageRank time, i.e. issue date: " << g.time(6285999) << std::endl;
     
     // illustrate changes in disruptiveness over time for PageRank patent
-    std::cout << "PageRank disruptiveness, 1995: " << pagerank95 << std::endl;
-    std::cout << "PageRank disruptiveness, 2002: " << pagerank02 << std::endl;
-    std::cout << "PageRank disruptiveness, 2005: " << pagerank05 << std::endl;
-    std::cout << "PageRank disruptiveness, 2010: " << pagerank10 << std::endl;
+    std::cout << "PageRank disruptiveness, 1995: " << pagerank95.disrupt << std::endl;
+    std::cout << "PageRank disruptiveness, 2002: " << pagerank02.disrupt << std::endl;
+    std::cout << "PageRank disruptiveness, 2005: " << pagerank05.disrupt << std::endl;
+    std::cout << "PageRank disruptiveness, 2010: " << pagerank10.disrupt << std::endl;
     
     // illustrate changes in in-degree (i.e., citations) over time for PageRank
     // patent
-    std::cout<<"PageRank in-degree, 1995: "<<g.indegree(6285999, 1995)<<std::endl;
-    std::cout<<"PageRank in-degree, 2002: "<<g.indegree(6285999, 2002)<<std::endl;
-    std::cout<<"PageRank in-degree, 2005: "<<g.indegree(6285999, 2005)<<std::endl;
-    std::cout<<"PageRank in-degree, 2010: "<<g.indegree(6285999, 2010)<<std::endl;
+    std::cout<<"PageRank in-degree, 1995: "<<pagerank95.indegree<<std::endl;
+    std::cout<<"PageRank in-degree, 2002: "<<pagerank02.indegree<<std::endl;
+    std::cout<<"PageRank in-degree, 2005: "<<pagerank05.indegree<<std::endl;
+    std::cout<<"PageRank in-degree, 2010: "<<pagerank10.indegree<<std::endl;
     
     // illustrate changes in radicalness (i.e., in-degree weighted disruptiveness)
     // over time for PageRank patent
-    std::cout<<"PageRank radicalness, 1995: "<<g.disrupt(6285999, 1995)*g.indegree(6285999, 1995)<<std::endl;
-    std::cout<<"PageRank radicalness, 2002: "<<g.disrupt(6285999, 2002)*g.indegree(6285999, 2002)<<std::endl;
-    std::cout<<"PageRank radicalness, 2005: "<<g.disrupt(6285999, 2005)*g.indegree(6285999, 2005)<<std::endl;
-    std::cout<<"PageRank radicalness, 2010: "<<g.disrupt(6285999, 2010)*g.indegree(6285999, 2010)<<std::endl;
+    std::cout<<"PageRank radicalness, 1995: "<<pagerank95.radical<<std::endl;
+    std::cout<<"PageRank radicalness, 2002: "<<pagerank02.radical<<std::endl;
+    std::cout<<"PageRank radicalness, 2005: "<<pagerank05.radical<<std::endl;
+    std::cout<<"PageRank radicalness, 2010: "<<pagerank10.radical<<std::endl;
+    
+    // the counts behind the 2010 measures, from which other variants can be
+    // derived without recomputing
+    std::cout<<"PageRank n_i, 2010: "<<pagerank10.n_i<<" (";
+    std::cout<<pagerank10.fonly<<" cite PageRank only, ";
+    std::cout<<pagerank10.both<<" cite PageRank and its predecessors, ";
+    std::cout<<pagerank10.bonly<<" cite its predecessors only)"<<std::endl;
+    
+    // windows fixed relative to the issue date compare patents of different
+    // ages: the CD index five and ten years after issue
+    Metrics pagerankcd5 = g.metrics_window(6285999, 0, 5);
+    Metrics pagerankcd10 = g.metrics_window(6285999, 0, 10);
+    std::cout<<"PageRank CD5: "<<pagerankcd5.disrupt<<std::endl;
+    std::cout<<"PageRank CD10: "<<pagerankcd10.disrupt<<std::endl;
     
     // illustrate disruptiveness for Axel patent
     std::cout << "Axel disruptiveness, 2010: " << axel10 << std::endl;
     
     // illustrate disruptiveness for Axel patent
     std::cout << "Monsanto disruptiveness, 2010: " << monsanto10 << std::endl;
+}
+
+// load the graph, and the dictionary of its ids if they are strings, append
+// to it and save it as asked to, reporting progress to log, with the graph
+// type chosen in main
+template <typename Graph>
+static Graph *load(const Options &options, IdDictionary &dictionary,
+                   std::vector<unsigned long> &affected, std::ostream &log) {
+    
+    // create a new edgraph object from files, or open a saved snapshot
+    Graph *graph;
+    
+    if (options.external > 0) {
+        log<<"Building snapshot out of core..."<<std::endl;
+        if (!Graph::buildsnapshot(options.vertexfile, options.edgefile,
+                                  options.savefile, options.external << 20,
+                                  options.threads)) {
+            std::cout << "could not write the file '" << options.savefile << "'" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        graph = new Graph(options.savefile);
+    }
+    else if (options.snapshotfile.empty() && options.ids == "string") {
+        log<<"Reading vertices and edges..."<<std::endl;
+        std::vector<std::pair<unsigned long, unsigned long> > vertices;
+        std::vector<std::pair<unsigned long, unsigned long> > edges;
+        std::string file;
+        std::vector<CSVError> errors;
+        unsigned long nerrors;
+        if (!readidcsv(options.vertexfile, options.edgefile, dictionary,
+                       vertices, edges, file, errors, nerrors)) {
+            if (nerrors == 0) {
+                std::cout << "could not open the file '" << file << "'" << std::endl;
+            }
+            for (std::vector<CSVError>::const_iterator it1 = errors.begin();
+                 it1 != errors.end(); ++it1) {
+                std::cout << file << ":" << it1->line << ": " << it1->message << std::endl;
+            }
+            if (nerrors > errors.size()) {
+                std::cout << file << ": " << nerrors - errors.size();
+                std::cout << " more malformed lines" << std::endl;
+            }
+            exit(EXIT_FAILURE);
+        }
+        log<<dictionary.size()<<" vertex ids"<<std::endl;
+        graph = new Graph(vertices, edges);
+    }
+    else if (options.snapshotfile.empty()) {
+        log<<"Reading vertices and edges..."<<std::endl;
+        graph = new Graph(options.vertexfile, options.edgefile, options.threads);
+    }
+    else {
+        log<<"Opening snapshot..."<<std::endl;
+        graph = new Graph(options.snapshotfile);
+        std::string idsfile = options.snapshotfile + ".ids";
+        if (options.ids == "string" && !dictionary.open(idsfile)) {
+            std::cout << "could not read the file '" << idsfile << "'" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+    Graph &g = *graph;
+    
+    // add new vertices and edges, e.g., those of another year, keeping track
+    // of the vertices whose metrics may change
+    if (!options.appendvertexfile.empty()) {
+        log<<"Appending vertices and edges..."<<std::endl;
+        g.append(options.appendvertexfile, options.appendedgefile, options.threads,
+                 affected);
+        log<<affected.size()<<" vertices affected"<<std::endl;
+    }
+    
+    // save a snapshot for faster startup next time, unless it was built out
+    // of core
+    if (!options.savefile.empty() && options.external == 0) {
+        log<<"Saving snapshot..."<<std::endl;
+        if (!g.save(options.savefile)) {
+            std::cout << "could not write the file '" << options.savefile << "'" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        std::string idsfile = options.savefile + ".ids";
+        if (options.ids == "string" && !dictionary.save(idsfile)) {
+            std::cout << "could not write the file '" << idsfile << "'" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+    
+    // compress once the graph is complete and saved, as it can no longer be
+    // changed or saved after
+    if (options.compress) {
+        log<<"Compressing adjacency lists..."<<std::endl;
+        unsigned long bytes = g.adjacencybytes();
+        g.compress();
+        log<<bytes<<" bytes of adjacency lists compressed to ";
+        log<<g.adjacencybytes()<<std::endl;
+    }
+    return graph;
+}
+
+// load the graph and compute the panel, with the graph type chosen in main
+template <typename Graph>
+static int run(const Options &options) {
+    
+    IdDictionary dictionary;
+    std::vector<unsigned long> affected;
+    Graph *graph = load<Graph>(options, dictionary, affected, std::cout);
+    Graph &g = *graph;
+    
+    // with no results file, that is all there is to do
+    if (options.resultsfile.empty()) {
+        report(options);
+        delete graph;
+        return 0;
+    }
+    
+    // the examples refer to patents by number
+    if (options.ids == "number") {
+        examples(g);
+    }
     
     // use this code to output year by year disruptiveness for all patents in list
     std::cout<<"Getting vertices..."<<std::endl;
     
     std::cout<<"Beginning calculations..."<<std::endl;
     
-    // open file to export results
+    // open file to export results, which are written out in large pieces
+    // rather than row by row
     std::ofstream results;
-    results.open(resultsfile.c_str());
+    results.open(options.resultsfile.c_str(),
+                 std::ios_base::out|std::ios_base::binary);
+    ResultsSink sink(results,
+                     options.format == "binary" ? ResultsSink::BINARY : ResultsSink::TEXT,
+                     options.echo ? &std::cout : NULL);
+    if (options.ids == "string") {
+        sink.dictionary(&dictionary);
+    }
     
     std::vector<unsigned long> verts = g.vertices();
     
-    for (int year = 1976; year <= 2010; year++) {
-        
-        for (std::vector<unsigned long>::iterator it1 = verts.begin();
-             it1 != verts.end(); ++it1) {
-            if (year >= g.time(*it1) && g.time(*it1) >= 1976) {
-                
-                std::cout<<*it1<<","; // vertex id (i.e., patent number)
-                std::cout<<g.time(*it1)<<","; // vertex time (i.e., patent issue date)
-                std::cout<<year<<","; // loop time (i.e., panel date)
-                std::cout<<g.disrupt(*it1,year)<<","; // disruptiveness
-                std::cout<<g.disrupt(*it1,year)*g.indegree(*it1,year)<<","; // radicalness
-                std::cout<<g.indegree(*it1,year)<<std::endl; // indegree
-                
-                results<<*it1<<","; // vertex id (i.e., patent number)
-                results<<g.time(*it1); // vertex time (i.e., patent issue date)
-                results<<","; // vertex time (i.e., patent issue date)
-                results<<year<<","; // loop time (i.e., panel date)
-                results<<g.disrupt(*it1,year)<<","; // disruptiveness
-                results<<g.disrupt(*it1,year)*g.indegree(*it1,year)<<","; // radicalness
-                results<<g.indegree(*it1,year)<<std::endl; // indegree
-                
-            }
+    // a shard computes the rows of its share of the vertices only
+    if (options.shards > 0) {
+        verts = shard(verts, options.shard, options.shards,
+                      options.shardby == "hash" ? SHARD_HASH : SHARD_RANGE);
+        std::cout<<"Shard "<<options.shard<<"/"<<options.shards<<": ";
+        std::cout<<verts.size()<<" vertices"<<std::endl;
+    }
+    
+    // compute the year by year panel on all cores; rows come out in the same
+    // order as a loop over years and then vertices, echoed to the screen
+    // unless asked not to; a graph built out of core is swept by default,
+    // since the series engine holds every vertex's counts for every year in
+    // memory regardless of the budget
+    typename PanelT<Graph>::Engine engine = PanelT<Graph>::SERIES;
+    if (options.engine == "sweep" || (options.engine.empty() && options.external > 0)) {
+        engine = PanelT<Graph>::SWEEP;
+    }
+    PanelT<Graph> panel(g, verts, 1976, 2010, options.threads, engine);
+    
+    // after an append, only the rows of the affected vertices need to be
+    // computed if the previous results are at hand
+    if (!options.previousfile.empty()) {
+        std::ifstream previous(options.previousfile.c_str());
+        if (!previous.is_open()) {
+            std::cout << "could not open the file '" << options.previousfile << "'" << std::endl;
+            exit(EXIT_FAILURE);
         }
+        if (!panel.update(previous, affected, sink)) {
+            sink.flush();
+            std::cout << "the file '" << options.previousfile << "' does not hold";
+            std::cout << " the previous results of this graph" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+    else {
+        panel.write(sink);
     }
     
     // close results file
+    sink.close();
+    results.close();
+    
+    report(options);
+    
+    delete graph;
+    
+    return 0;
+}
+
+// load the graph and answer lookups on it until the end of the input, or
+// for good on a socket; on standard input and output, responses alone go to
+// standard output
+template <typename Graph>
+static int serve(const Options &options) {
+    
+    IdDictionary dictionary;
+    std::vector<unsigned long> affected;
+    Graph *graph = load<Graph>(options, dictionary, affected, std::cerr);
+    ServerT<Graph> server(*graph, options.ids == "string" ? &dictionary : NULL,
+                          options.threads);
+    
+    if (options.socketfile.empty()) {
+        std::cerr<<"Answering requests..."<<std::endl;
+        if (!server.serve(0, 1)) {
+            std::cerr << "could not read requests or write responses" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        report(options, std::cerr);
+    }
+    else {
+        std::cout<<"Answering requests on '"<<options.socketfile<<"'..."<<std::endl;
+        std::string message;
+        server.listen(options.socketfile, message);
+        std::cout << message << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    
+    delete graph;
+    
+    return 0;
+}
+
+// merge the part files of a sharded panel, args[1] and on, into the results
+// file args[0], and write the checksum of the results next to it
+static int merge(const std::vector<std::string> &args) {
+    
+    std::cout<<"Merging parts..."<<std::endl;
+    
+    std::ofstream results(args[0].c_str(), std::ios_base::out|std::ios_base::binary);
+    if (!results.is_open()) {
+        std::cout << "could not open the file '" << args[0] << "'" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    
+    std::vector<std::string> parts(args.begin() + 1, args.end());
+    unsigned long rows;
+    uint64_t checksum;
+    std::string message;
+    if (!mergeparts(parts, results, rows, checksum, message)) {
+        std::cout << message << std::endl;
+        exit(EXIT_FAILURE);
+    }
     results.close();
     
+    char hex[17];
+    snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)checksum);
+    std::cout<<rows<<" rows, checksum "<<hex<<std::endl;
+    
+    std::string checksumfile = args[0] + ".checksum";
+    std::ofstream out(checksumfile.c_str());
+    out << "fnv1a64 " << hex << " " << rows << "\n";
+    out.close();
+    if (results.fail() || out.fail()) {
+        std::cout << "could not write the file '" << args[0] << "'" << std::endl;
+        exit(EXIT_FAILURE);
+    }
     return 0;
 }
 
+int main (int argc, char* argv[])
+{
+    
+    Options options;
+    bool merging = false;
+    
+    std::vector<std::string> args;
+    for (int k = 1; k < argc; k++) {
+        std::string arg = argv[k];
+        if (arg == "--threads" && k + 1 < argc) {
+            options.threads = atoi(argv[++k]);
+        }
+        else if (arg == "--snapshot" && k + 1 < argc) {
+            options.snapshotfile = argv[++k];
+        }
+        else if (arg == "--save" && k + 1 < argc) {
+            options.savefile = argv[++k];
+        }
+        else if (arg == "--types" && k + 1 < argc) {
+            options.types = argv[++k];
+        }
+        else if (arg == "--ids" && k + 1 < argc) {
+            options.ids = argv[++k];
+        }
+        else if (arg == "--engine" && k + 1 < argc) {
+            options.engine = argv[++k];
+        }
+        else if (arg == "--append" && k + 2 < argc) {
+            options.appendvertexfile = argv[++k];
+            options.appendedgefile = argv[++k];
+        }
+        else if (arg == "--update" && k + 1 < argc) {
+            options.previousfile = argv[++k];
+        }
+        else if (arg == "--format" && k + 1 < argc) {
+            options.format = argv[++k];
+        }
+        else if (arg == "--quiet") {
+            options.echo = false;
+        }
+        else if (arg == "--external" && k + 1 < argc) {
+            options.external = strtoul(argv[++k], NULL, 10);
+        }
+        else if (arg == "--shard" && k + 1 < argc) {
+            if (sscanf(argv[++k], "%lu/%lu", &options.shard, &options.shards) != 2 ||
+                options.shard >= options.shards) {
+                options.shards = ULONG_MAX;
+            }
+        }
+        else if (arg == "--shard-by" && k + 1 < argc) {
+            options.shardby = argv[++k];
+        }
+        else if (arg == "--merge") {
+            merging = true;
+        }
+        else if (arg == "--serve") {
+            options.serve = true;
+        }
+        else if (arg == "--socket" && k + 1 < argc) {
+            options.serve = true;
+            options.socketfile = argv[++k];
+        }
+        else if (arg == "--compress") {
+            options.compress = true;
+        }
+        else if (arg == "--stats") {
+            options.stats = true;
+        }
+        else if (arg == "--stats-json" && k + 1 < argc) {
+            options.statsfile = argv[++k];
+        }
+        else {
+            args.push_back(arg);
+        }
+    }
+    
+    bool usage = false;
+    
+    // merging the parts of a sharded panel needs no graph
+    if (merging && args.size() >= 2) {
+        return merge(args);
+    }
+    
+    if (merging) {
+        usage = true;
+    }
+    else if (options.serve) {
+        
+        // a server has no results file, and the graph either comes from a
+        // snapshot or the csv files
+        if (options.snapshotfile.empty() && args.size() == 2) {
+            options.vertexfile = args[0];
+            options.edgefile = args[1];
+        }
+        else if (options.snapshotfile.empty() || !args.empty()) {
+            usage = true;
+        }
+        if (!options.previousfile.empty() || options.shards > 0) {
+            usage = true;
+        }
+    }
+    else if (!options.snapshotfile.empty() && args.size() == 1) {
+        options.resultsfile = args[0];
+    }
+    else if (options.snapshotfile.empty() &&
+             (args.size() == 3 || (args.size() == 2 && !options.savefile.empty()))) {
+        options.vertexfile = args[0];
+        options.edgefile = args[1];
+        if (args.size() == 3) {
+            options.resultsfile = args[2];
+        }
+    }
+    else {
+        usage = true;
+    }
+    if (!options.engine.empty() && options.engine != "series" &&
+        options.engine != "sweep") {
+        usage = true;
+    }
+    if (options.format != "text" && options.format != "binary") {
+        usage = true;
+    }
+    if (!options.previousfile.empty() && options.format != "text") {
+        usage = true;
+    }
+    if (options.external > 0 &&
+        (options.savefile.empty() || !options.snapshotfile.empty() ||
+         !options.appendvertexfile.empty())) {
+        usage = true;
+    }
+    if (!options.previousfile.empty() &&
+        (options.appendvertexfile.empty() || options.resultsfile.empty())) {
+        usage = true;
+    }
+    
+    // shards share one snapshot rather than each reading the csv files, and
+    // write text parts, the only ones --merge reads
+    if (options.shards > 0 &&
+        (options.shards == ULONG_MAX || options.snapshotfile.empty() ||
+         (options.shardby != "range" && options.shardby != "hash") ||
+         options.format != "text")) {
+        usage = true;
+    }
+    
+    // a snapshot is opened with the types it was saved with
+    if (!usage && !options.snapshotfile.empty()) {
+        uint32_t indexbytes;
+        uint32_t timebytes;
+        if (snapshottypes(options.snapshotfile, indexbytes, timebytes)) {
+            if (indexbytes == 4 && timebytes == 4) {
+                options.types = "32";
+            }
+            else if (indexbytes == 4 && timebytes == 2) {
+                options.types = "compact";
+            }
+            else {
+                options.types = "long";
+            }
+        }
+        std::ifstream ids((options.snapshotfile + ".ids").c_str());
+        if (ids.is_open()) {
+            options.ids = "string";
+        }
+    }
+    
+    // string ids are numbered once, as the graph is read, while appending,
+    // updating and merging results go by number
+    if (options.ids != "number" && options.ids != "string") {
+        usage = true;
+    }
+    if (options.ids == "string" &&
+        (!options.appendvertexfile.empty() || options.shards > 0 ||
+         options.external > 0)) {
+        usage = true;
+    }
+    
+    if (!usage && options.types == "long") {
+        return options.serve ? serve<EDGraph>(options) : run<EDGraph>(options);
+    }
+    if (!usage && options.types == "32") {
+        return options.serve ? serve<EDGraph32>(options) : run<EDGraph32>(options);
+    }
+    if (!usage && options.types == "compact") {
+        return options.serve ? serve<CompactEDGraph>(options) :
+                               run<CompactEDGraph>(options);
+    }
+    
+    std::cout << "usage: " << argv[0];
+    std::cout << " [--threads n] [--engine series|sweep] [--format text|binary] [--quiet] [--stats] [--stats-json statsfile] [--compress] [--types long|32|compact] [--ids number|string] [--append vertexfile edgefile [--update previousresultsfile]] [--save snapshotfile [--external megabytes]] [vertexfile] [edgefile] [resultsfile]" << std::endl;
+    std::cout << "       " << argv[0];
+    std::cout << " [--threads n] [--engine series|sweep] [--format text|binary] [--quiet] [--stats] [--stats-json statsfile] [--compress] [--append vertexfile edgefile [--update previousresultsfile]] [--shard k/n [--shard-by range|hash]] --snapshot snapshotfile [resultsfile]" << std::endl;
+    std::cout << "       " << argv[0];
+    std::cout << " --merge resultsfile partfile..." << std::endl;
+    std::cout << "       " << argv[0];
+    std::cout << " --serve|--socket socketfile [--threads n] [--stats] [--compress] [--types long|32|compact] [--ids number|string] [--append vertexfile edgefile] [--save snapshotfile] [--snapshot snapshotfile | vertexfile edgefile]" << std::endl;
+    exit(EXIT_FAILURE);
+}
+
 
 /* TODO
  - If I don't want to supply a default value for undefined values, I
@@ -202,16 +705,10 @@ int main (int argc, char* argv[])
  (http://stackoverflow.com/questions/2639255/c-return-a-null-object-if-search-result-not-found)
  - Related: need a better way for returning undefined values (e.g., indegree might return 0 when actually undefined)
  
- - serialization
- - need to use templating!!!!
  - inline?
  - code review from someone
  - boost python interface
  - find other c++ code examples
- - After extensive testing, I have found that the program can be sped up
- immensely by using integer ids. Thus, I suggest a few options: (1) require a
- vertex list for hashing, (2) make the default assume integer ids but allow an
- option for strings [perhaps templating?].
  - Think very hard about using an std::vector<pair<int, float> >, and using
  std::lower_bound, std::upper_bound, and/or std::equal_range to look up values.
  This approach offers speed improvements (tested) though not nearly as much as
@@ -0,0 +1,104 @@
+//-----------------------------------------------------------------------------
+// File        : mappedfile.cpp
+// Description : Read-only memory-mapped file
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012, Russell J. Funk and Jason Owen Smith
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the University of Michigan nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL RUSSELL J. FUNK OR JASON OWEN-SMITH BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+// Author    : Russell J. Funk
+// Email     : funk@umich.edu
+// Web page  : http://www-personal.umich.edu/~funk/index.html
+// Location  : University of Michigan, Ann Arbor, Michigan
+// Date      : December 15, 2012
+// Reference : http://arxiv.org/abs/1212.3559 (pp. 6-8 and pp. 24-25)
+//-----------------------------------------------------------------------------
+
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "mappedfile.h"
+
+MappedFile::MappedFile() : data_(NULL), size_(0) {
+}
+
+MappedFile::~MappedFile() {
+    MappedFile::close();
+}
+
+// map the file
+bool MappedFile::open(const std::string &file) {
+    
+    MappedFile::close();
+    
+    int fd = ::open(file.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+    
+    // an empty file cannot be mapped, but is perfectly readable
+    if (st.st_size > 0) {
+        void *data = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (data == MAP_FAILED) {
+            ::close(fd);
+            return false;
+        }
+        data_ = static_cast<const char *>(data);
+        size_ = st.st_size;
+    }
+    
+    // the mapping stays valid after the descriptor is closed
+    ::close(fd);
+    return true;
+}
+
+// release the mapping
+void MappedFile::close() {
+    if (data_ != NULL) {
+        munmap(const_cast<char *>(data_), size_);
+    }
+    data_ = NULL;
+    size_ = 0;
+}
+
+// contents of the file
+const char *MappedFile::data() const {
+    return data_;
+}
+
+// length of the file in bytes
+unsigned long MappedFile::size() const {
+    return size_;
+}
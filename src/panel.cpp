@@ -0,0 +1,427 @@
+//-----------------------------------------------------------------------------
+// File        : panel.cpp
+// Description : Parallel engine for vertex-by-year panels
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012, Russell J. Funk and Jason Owen Smith
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the University of Michigan nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL RUSSELL J. FUNK OR JASON OWEN-SMITH BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+// Author    : Russell J. Funk
+// Email     : funk@umich.edu
+// Web page  : http://www-personal.umich.edu/~funk/index.html
+// Location  : University of Michigan, Ann Arbor, Michigan
+// Date      : December 15, 2012
+// Reference : http://arxiv.org/abs/1212.3559 (pp. 6-8 and pp. 24-25)
+//-----------------------------------------------------------------------------
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <condition_variable>
+#include <deque>
+#include <istream>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "edgraph_v1.h"
+#include "panel.h"
+#include "results.h"
+#include "stats.h"
+
+namespace {
+
+// queue of task numbers owned by one worker thread; the owner and thieves
+// both take from the front, so every queue is worked off in output order
+struct TaskQueue {
+    std::mutex lock;
+    std::deque<unsigned long> tasks;
+};
+
+// outcome of looking for a task
+enum TakeResult { TAKE_OK, TAKE_WAIT, TAKE_DONE };
+
+// take the next task for worker w, first from its own queue and otherwise by
+// stealing from the others; tasks at or beyond limit are left alone so that
+// the number of finished but unwritten tasks stays bounded
+TakeResult take(std::vector<TaskQueue> &queues, unsigned int w,
+                unsigned long limit, unsigned long &t) {
+    
+    bool pending = false;
+    
+    for (unsigned int k = 0; k < queues.size(); k++) {
+        TaskQueue &queue = queues[(w + k) % queues.size()];
+        std::lock_guard<std::mutex> guard(queue.lock);
+        if (queue.tasks.empty()) {
+            continue;
+        }
+        if (queue.tasks.front() >= limit) {
+            pending = true;
+            continue;
+        }
+        t = queue.tasks.front();
+        queue.tasks.pop_front();
+        return TAKE_OK;
+    }
+    return pending ? TAKE_WAIT : TAKE_DONE;
+}
+
+// run tasks 0 .. ntasks - 1 on threads workers; work(t, buffer) runs task t
+// and leaves its output in buffer, and emit(buffer) is called on the calling
+// thread with the output of each task, strictly in task order
+template <typename Work, typename Emit>
+void schedule(unsigned long ntasks, unsigned int threads, Work work, Emit emit) {
+    
+    // deal the tasks out round robin, so that every queue starts near the
+    // front
+    std::vector<TaskQueue> queues(threads);
+    for (unsigned long t = 0; t < ntasks; t++) {
+        queues[t % threads].tasks.push_back(t);
+    }
+    
+    // finished tasks waiting to be emitted, and how far emitting has got
+    unsigned long window = 64*threads;
+    std::vector<std::string> rows(ntasks);
+    std::vector<char> done(ntasks, 0);
+    std::atomic<unsigned long> written(0);
+    std::mutex lock;
+    std::condition_variable donecv;
+    std::condition_variable writtencv;
+    
+    std::vector<std::thread> workers;
+    for (unsigned int w = 0; w < threads; w++) {
+        workers.push_back(std::thread([&, w]() {
+            std::string buffer;
+            for (;;) {
+                unsigned long t;
+                unsigned long limit = written.load() + window;
+                TakeResult result = take(queues, w, limit, t);
+                if (result == TAKE_DONE) {
+                    break;
+                }
+                if (result == TAKE_WAIT) {
+                    std::unique_lock<std::mutex> guard(lock);
+                    writtencv.wait(guard, [&]() {
+                        return written.load() + window > limit;
+                    });
+                    continue;
+                }
+                buffer.clear();
+                work(t, buffer);
+                {
+                    std::lock_guard<std::mutex> guard(lock);
+                    rows[t].swap(buffer);
+                    done[t] = 1;
+                }
+                donecv.notify_one();
+            }
+        }));
+    }
+    
+    // emit the tasks in order as they finish
+    std::string buffer;
+    for (unsigned long t = 0; t < ntasks; t++) {
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            donecv.wait(guard, [&]() { return done[t] != 0; });
+            buffer.swap(rows[t]);
+            std::string().swap(rows[t]);
+        }
+        emit(buffer);
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            written.store(t + 1);
+        }
+        writtencv.notify_all();
+    }
+    
+    for (unsigned int w = 0; w < threads; w++) {
+        workers[w].join();
+    }
+}
+
+}
+
+// panel over vertices for years firstyear .. lastyear
+template <typename Graph>
+PanelT<Graph>::PanelT(const Graph &g, const std::vector<unsigned long> &vertices,
+                      unsigned long firstyear, unsigned long lastyear,
+                      unsigned int threads, Engine engine)
+    : g_(g), firstyear_(firstyear), lastyear_(lastyear), threads_(threads),
+      grain_(64), engine_(engine) {
+    
+    // vertices that never get a row are dropped up front
+    for (std::vector<unsigned long>::const_iterator it1 = vertices.begin();
+         it1 != vertices.end(); ++it1) {
+        unsigned long time = g_.time(*it1);
+        if (time >= firstyear_ && time <= lastyear_) {
+            vertices_.push_back(*it1);
+            times_.push_back(time);
+        }
+    }
+    
+    if (threads_ == 0) {
+        threads_ = std::thread::hardware_concurrency();
+    }
+    if (threads_ == 0) {
+        threads_ = 1;
+    }
+}
+
+// number of worker threads in use
+template <typename Graph>
+unsigned int PanelT<Graph>::threads() const {
+    return threads_;
+}
+
+// compute the counts of one block of vertices for all years
+template <typename Graph>
+void PanelT<Graph>::compute(unsigned long block, std::vector<Cell> &cells) const {
+    
+    unsigned long n = vertices_.size();
+    unsigned long begin = block*grain_;
+    unsigned long end = std::min<unsigned long>(begin + grain_, n);
+    
+    // scratch space of this worker thread, reused from block to block
+    static thread_local Workspace workspace;
+    static thread_local std::vector<Metrics> series;
+    
+    for (unsigned long k = begin; k < end; k++) {
+        g_.disrupt_series(vertices_[k], times_[k], lastyear_, series, workspace);
+        for (unsigned long j = 0; j < series.size(); j++) {
+            Cell &cell = cells[(times_[k] + j - firstyear_)*n + k];
+            cell.fonly = series[j].fonly;
+            cell.both = series[j].both;
+            cell.bonly = series[j].bonly;
+            cell.indegree = series[j].indegree;
+        }
+    }
+}
+
+// format the rows of one block of vertices in one year
+template <typename Graph>
+void PanelT<Graph>::format(unsigned long year, unsigned long block,
+                           const std::vector<Cell> &cells, const ResultsSink &sink,
+                           std::string &rows) const {
+    
+    unsigned long n = vertices_.size();
+    unsigned long begin = block*grain_;
+    unsigned long end = std::min<unsigned long>(begin + grain_, n);
+    
+    for (unsigned long k = begin; k < end; k++) {
+        if (year >= times_[k]) {
+            const Cell &cell = cells[(year - firstyear_)*n + k];
+            sink.encode(rows, vertices_[k], times_[k], year,
+                        tally(cell.fonly, cell.both, cell.bonly, cell.indegree));
+        }
+    }
+}
+
+// format the rows of one block of vertices in the year a sweep has reached
+template <typename Graph>
+void PanelT<Graph>::format(const Sweep &sweep, unsigned long block,
+                           const ResultsSink &sink, std::string &rows) const {
+    
+    unsigned long n = vertices_.size();
+    unsigned long begin = block*grain_;
+    unsigned long end = std::min<unsigned long>(begin + grain_, n);
+    unsigned long year = sweep.endtime();
+    
+    for (unsigned long k = begin; k < end; k++) {
+        if (year >= times_[k]) {
+            sink.encode(rows, vertices_[k], times_[k], year,
+                        g_.swept(sweep, vertices_[k]));
+        }
+    }
+}
+
+// compute the panel and write it to sink
+template <typename Graph>
+void PanelT<Graph>::write(ResultsSink &sink) const {
+    
+    EDGRAPH_STATS_TIMER(STATS_PANEL);
+    
+    if (vertices_.empty() || lastyear_ < firstyear_) {
+        return;
+    }
+    
+    if (engine_ == SWEEP) {
+        PanelT::writesweep(sink);
+    }
+    else {
+        PanelT::writeseries(sink);
+    }
+}
+
+// compute every vertex for all years, then write the rows out year by year
+template <typename Graph>
+void PanelT<Graph>::writeseries(ResultsSink &sink) const {
+    
+    unsigned long n = vertices_.size();
+    unsigned long years = lastyear_ - firstyear_ + 1;
+    unsigned long blocks = (n + grain_ - 1)/grain_;
+    
+    // compute every vertex for all years
+    std::vector<Cell> cells(years*n);
+    schedule(blocks, threads_,
+             [&](unsigned long t, std::string &) {
+                 PanelT::compute(t, cells);
+             },
+             [](const std::string &) {});
+    
+    // then write them out year by year
+    schedule(years*blocks, threads_,
+             [&](unsigned long t, std::string &rows) {
+                 PanelT::format(firstyear_ + t/blocks, t % blocks, cells, sink, rows);
+             },
+             [&](const std::string &rows) {
+                 sink.write(rows);
+             });
+}
+
+// sweep the citing vertices year by year, writing each year's rows as soon as
+// the sweep reaches its end
+template <typename Graph>
+void PanelT<Graph>::writesweep(ResultsSink &sink) const {
+    
+    unsigned long n = vertices_.size();
+    unsigned long blocks = (n + grain_ - 1)/grain_;
+    
+    // the panel has no vertices before firstyear_, so neither do their
+    // citers need sweeping
+    Sweep sweep(firstyear_);
+    
+    for (unsigned long year = firstyear_; year <= lastyear_; year++) {
+        g_.sweep(sweep, year, threads_);
+        schedule(blocks, threads_,
+                 [&](unsigned long t, std::string &rows) {
+                     PanelT::format(sweep, t, sink, rows);
+                 },
+                 [&](const std::string &rows) {
+                     sink.write(rows);
+                 });
+    }
+}
+
+// write the panel by updating a previous one
+template <typename Graph>
+bool PanelT<Graph>::update(std::istream &previous,
+                           const std::vector<unsigned long> &affected,
+                           ResultsSink &sink) const {
+    
+    EDGRAPH_STATS_TIMER(STATS_PANEL);
+    
+    // previous rows are copied as they are
+    if (sink.format() != ResultsSink::TEXT) {
+        return false;
+    }
+    
+    if (vertices_.empty() || lastyear_ < firstyear_) {
+        return true;
+    }
+    
+    // compute the affected vertices of the panel, in panel order, as a
+    // panel of their own
+    std::vector<unsigned long> recompute;
+    for (std::vector<unsigned long>::const_iterator it1 = vertices_.begin();
+         it1 != vertices_.end(); ++it1) {
+        if (std::binary_search(affected.begin(), affected.end(), *it1)) {
+            recompute.push_back(*it1);
+        }
+    }
+    PanelT sub(g_, recompute, firstyear_, lastyear_, threads_);
+    
+    unsigned long m = sub.vertices_.size();
+    unsigned long years = lastyear_ - firstyear_ + 1;
+    
+    std::vector<Cell> cells(years*m);
+    schedule((m + grain_ - 1)/grain_, threads_,
+             [&](unsigned long t, std::string &) {
+                 sub.compute(t, cells);
+             },
+             [](const std::string &) {});
+    
+    // then merge them with the previous rows of the other vertices, which
+    // come in the same order; the previous rows of the affected vertices
+    // are skipped
+    std::string line;
+    std::string rows;
+    
+    for (unsigned long year = firstyear_; year <= lastyear_; year++) {
+        unsigned long j = 0;
+        for (unsigned long k = 0; k < vertices_.size(); k++) {
+            bool recomputed = j < m && sub.vertices_[j] == vertices_[k];
+            if (recomputed) {
+                j++;
+            }
+            if (year < times_[k]) {
+                continue;
+            }
+            
+            rows.clear();
+            if (recomputed) {
+                const Cell &cell = cells[(year - firstyear_)*m + j - 1];
+                sink.encode(rows, vertices_[k], times_[k], year,
+                            tally(cell.fonly, cell.both, cell.bonly, cell.indegree));
+            }
+            else {
+                bool found = false;
+                while (!found && std::getline(previous, line)) {
+                    
+                    // the vertex and year of the row
+                    const char *field = line.c_str();
+                    char *next;
+                    unsigned long vertex = strtoul(field, &next, 10);
+                    if (*next != ',') {
+                        return false;
+                    }
+                    if (std::binary_search(affected.begin(), affected.end(), vertex)) {
+                        continue;
+                    }
+                    strtoul(next + 1, &next, 10);
+                    if (*next != ',' || vertex != vertices_[k] ||
+                        strtoul(next + 1, NULL, 10) != year) {
+                        return false;
+                    }
+                    found = true;
+                }
+                if (!found) {
+                    return false;
+                }
+                rows.append(line);
+                rows.push_back('\n');
+            }
+            sink.write(rows);
+        }
+    }
+    return true;
+}
+
+// the panels of the graph types compiled into the library
+template class PanelT<EDGraph>;
+template class PanelT<EDGraph32>;
+template class PanelT<CompactEDGraph>;
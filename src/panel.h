@@ -0,0 +1,153 @@
+//-----------------------------------------------------------------------------
+// File        : panel.h
+// Description : Declares a parallel engine for vertex-by-year panels
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012, Russell J. Funk and Jason Owen Smith
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the University of Michigan nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL RUSSELL J. FUNK OR JASON OWEN-SMITH BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+// Author    : Russell J. Funk
+// Email     : funk@umich.edu
+// Web page  : http://www-personal.umich.edu/~funk/index.html
+// Location  : University of Michigan, Ann Arbor, Michigan
+// Date      : December 15, 2012
+// Reference : http://arxiv.org/abs/1212.3559 (pp. 6-8 and pp. 24-25)
+//-----------------------------------------------------------------------------
+
+#ifndef _PANEL_H
+#define _PANEL_H
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "edgraph_v1.h"
+#include "results.h"
+
+// computes a panel of disruptiveness, radicalness and in-degree for a set of
+// vertices over a range of years, and writes it to a ResultsSink as rows
+//
+//     vertex,time,year,disruptiveness,radicalness,indegree
+//
+// ordered by year and then by the order of the vertices given; a vertex has
+// a row for every year from its own time onward, provided that its time is
+// no earlier than the first year of the panel
+//
+// by default (SERIES) the panel is computed vertex by vertex, all years at
+// once (see EDGraphT::disrupt_series), and held in memory until it is
+// written out year by year. both steps cut the work into tasks that are
+// dealt out to per-thread queues; since the cost of a vertex varies hugely
+// with the in-degree of its predecessors, threads that run out of work steal
+// tasks from the others. alternatively (SWEEP), the citing vertices are swept
+// in time order (see EDGraphT::sweep), each year's rows being written as soon
+// as the sweep reaches its end, which keeps only three counts per vertex in
+// memory and goes through each two-step citation path once rather than once
+// per focal vertex. rows are written strictly in order, so the output is
+// identical for either engine and any number of threads; Graph is one of the
+// graph types of edgraph_v1.h
+template <typename Graph>
+class PanelT {
+    
+private:
+    
+    // graph the panel is computed from
+    const Graph &g_;
+    
+    // vertices in output order and their times
+    std::vector<unsigned long> vertices_;
+    std::vector<unsigned long> times_;
+    
+    // first and last year of the panel
+    unsigned long firstyear_;
+    unsigned long lastyear_;
+    
+    // number of worker threads and vertices per task
+    unsigned int threads_;
+    unsigned long grain_;
+    
+    // how the panel is computed, see Engine
+    int engine_;
+    
+    // the counts of one vertex in one year (see Metrics), which is all that
+    // is kept in memory until the panel is written; 32 bits suffice for
+    // graphs of fewer than 2^32 vertices and edges per vertex
+    struct Cell {
+        unsigned int fonly;
+        unsigned int both;
+        unsigned int bonly;
+        unsigned int indegree;
+    };
+    
+    // compute the counts of one block of vertices for all years; the counts
+    // of vertex k in year y are stored in cells[(y - firstyear_)*n + k]
+    void compute(unsigned long block, std::vector<Cell> &cells) const;
+    
+    // format the rows of one block of vertices in one year
+    void format(unsigned long year, unsigned long block,
+                const std::vector<Cell> &cells, const ResultsSink &sink,
+                std::string &rows) const;
+    
+    // format the rows of one block of vertices in the year a sweep has
+    // reached
+    void format(const Sweep &sweep, unsigned long block, const ResultsSink &sink,
+                std::string &rows) const;
+    
+    // write the panel with each engine
+    void writeseries(ResultsSink &sink) const;
+    void writesweep(ResultsSink &sink) const;
+    
+public:
+    
+    // ways of computing the panel, see above
+    enum Engine { SERIES, SWEEP };
+    
+    // panel over vertices for years firstyear .. lastyear; threads = 0 uses
+    // one thread per hardware core
+    PanelT(const Graph &g, const std::vector<unsigned long> &vertices,
+           unsigned long firstyear, unsigned long lastyear,
+           unsigned int threads = 0, Engine engine = SERIES);
+    
+    // number of worker threads in use
+    unsigned int threads() const;
+    
+    // compute the panel and write it to sink
+    void write(ResultsSink &sink) const;
+    
+    // write the panel by updating a previous one, for the same vertices in
+    // the same order and the same years, after vertices and edges were
+    // appended to the graph (see EDGraphT::append): the rows of the affected
+    // vertices (sorted) are computed anew, while all other rows are copied
+    // from previous, which must be text, as must the sink. returns false,
+    // having written the rows up to that point, if previous does not hold
+    // the rows expected
+    bool update(std::istream &previous, const std::vector<unsigned long> &affected,
+                ResultsSink &sink) const;
+    
+};
+
+typedef PanelT<EDGraph> Panel;
+
+#endif
@@ -0,0 +1,236 @@
+//-----------------------------------------------------------------------------
+// File        : results.cpp
+// Description : Buffered sink for the rows of a panel, as text or binary
+//-----------------------------------------------------------------------------
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the University of Michigan nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL RUSSELL J. FUNK OR JASON OWEN-SMITH BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+// Author    : Russell J. Funk
+// Email     : funk@umich.edu
+// Web page  : http://www-personal.umich.edu/~funk/index.html
+// Location  : University of Michigan, Ann Arbor, Michigan
+// Date      : December 15, 2012
+// Reference : http://arxiv.org/abs/1212.3559 (pp. 6-8 and pp. 24-25)
+//-----------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <ostream>
+#include <string>
+
+#include "dictionary.h"
+#include "edgraph_v1.h"
+#include "results.h"
+
+// append the decimal digits of value
+static void append(std::string &rows, unsigned long value) {
+    char digits[20];
+    int n = 0;
+    do {
+        digits[n++] = '0' + value % 10;
+        value /= 10;
+    } while (value != 0);
+    while (n > 0) {
+        rows.push_back(digits[--n]);
+    }
+}
+
+// append value as an ostream with default settings would write it
+static void append(std::string &rows, double value) {
+    char text[32];
+    int n = snprintf(text, sizeof(text), "%g", value);
+    rows.append(text, n);
+}
+
+// append the bytes of value
+template <typename T>
+static void append(std::string &rows, T value) {
+    rows.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+// sink writing to results in format and, if the format is text, to echo
+ResultsSink::ResultsSink(std::ostream &results, Format format, std::ostream *echo,
+                         std::size_t capacity)
+    : results_(results), format_(format), echo_(format == TEXT ? echo : NULL),
+      capacity_(capacity), ids_(NULL), rows_(0), header_(-1), closed_(false) {
+    
+    buffer_.reserve(capacity_ + (1 << 16));
+    
+    if (format_ == BINARY) {
+        ResultsHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, resultsmagic, sizeof(header.magic));
+        header.version = resultsversion;
+        header.byteorder = resultsbyteorder;
+        header.columns = 5;
+        
+        header_ = results_.tellp();
+        results_.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    }
+}
+
+// format of the results
+ResultsSink::Format ResultsSink::format() const {
+    return static_cast<Format>(format_);
+}
+
+// write the vertices of text rows as ids
+void ResultsSink::dictionary(const IdDictionary *ids) {
+    ids_ = ids;
+}
+
+// append one row, encoded in the format of the sink, to rows
+void ResultsSink::encode(std::string &rows, unsigned long vertex,
+                         unsigned long time, unsigned long year,
+                         const Metrics &m) const {
+    
+    if (format_ == BINARY) {
+        
+        // a record of recordbytes bytes, turned into columns by drain()
+        append<uint64_t>(rows, vertex);
+        append<uint32_t>(rows, year);
+        append<uint32_t>(rows, m.indegree);
+        append<double>(rows, m.disrupt);
+        append<double>(rows, m.radical);
+        return;
+    }
+    
+    if (ids_ != NULL) {
+        ids_->append(rows, vertex); // vertex id (e.g., DOI)
+    }
+    else {
+        append(rows, vertex); // vertex id (i.e., patent number)
+    }
+    rows.push_back(',');
+    append(rows, time); // vertex time (i.e., patent issue date)
+    rows.push_back(',');
+    append(rows, year); // loop time (i.e., panel date)
+    rows.push_back(',');
+    append(rows, m.disrupt); // disruptiveness
+    rows.push_back(',');
+    append(rows, m.radical); // radicalness
+    rows.push_back(',');
+    append(rows, m.indegree); // indegree
+    rows.push_back('\n');
+}
+
+// add rows encoded by encode() to the results
+void ResultsSink::write(const std::string &rows) {
+    
+    if (format_ == BINARY) {
+        rows_ += rows.size()/recordbytes;
+    }
+    else {
+        rows_ += std::count(rows.begin(), rows.end(), '\n');
+    }
+    
+    buffer_.append(rows);
+    if (buffer_.size() >= capacity_) {
+        ResultsSink::drain();
+    }
+}
+
+// number of rows added so far
+unsigned long ResultsSink::rows() const {
+    return rows_;
+}
+
+// write out the buffered rows
+void ResultsSink::drain() {
+    
+    if (buffer_.empty()) {
+        return;
+    }
+    
+    if (format_ == BINARY) {
+        
+        // a group of rows, column by column
+        uint64_t n = buffer_.size()/recordbytes;
+        const char *records = buffer_.data();
+        
+        columns_.clear();
+        append<uint64_t>(columns_, n);
+        for (uint64_t k = 0; k < n; k++) {
+            columns_.append(records + k*recordbytes, 8);
+        }
+        for (uint64_t k = 0; k < n; k++) {
+            columns_.append(records + k*recordbytes + 8, 4);
+        }
+        for (uint64_t k = 0; k < n; k++) {
+            columns_.append(records + k*recordbytes + 16, 8);
+        }
+        for (uint64_t k = 0; k < n; k++) {
+            columns_.append(records + k*recordbytes + 24, 8);
+        }
+        for (uint64_t k = 0; k < n; k++) {
+            columns_.append(records + k*recordbytes + 12, 4);
+        }
+        results_.write(columns_.data(), columns_.size());
+    }
+    else {
+        results_.write(buffer_.data(), buffer_.size());
+        if (echo_ != NULL) {
+            echo_->write(buffer_.data(), buffer_.size());
+        }
+    }
+    buffer_.clear();
+}
+
+// write out the buffered rows and flush the streams
+void ResultsSink::flush() {
+    ResultsSink::drain();
+    results_.flush();
+    if (echo_ != NULL) {
+        echo_->flush();
+    }
+}
+
+// flush and record the number of rows in the header of a binary file
+void ResultsSink::close() {
+    
+    if (closed_) {
+        return;
+    }
+    closed_ = true;
+    
+    ResultsSink::drain();
+    
+    if (format_ == BINARY && header_ != std::streamoff(-1)) {
+        std::streampos end = results_.tellp();
+        uint64_t rows = rows_;
+        results_.seekp(header_ + std::streamoff(offsetof(ResultsHeader, rows)));
+        results_.write(reinterpret_cast<const char *>(&rows), sizeof(rows));
+        results_.seekp(end);
+    }
+    
+    ResultsSink::flush();
+}
+
+// closes the sink
+ResultsSink::~ResultsSink() {
+    ResultsSink::close();
+}
@@ -0,0 +1,160 @@
+//-----------------------------------------------------------------------------
+// File        : results.h
+// Description : Buffered sink for the rows of a panel, as text or binary
+//-----------------------------------------------------------------------------
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the University of Michigan nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL RUSSELL J. FUNK OR JASON OWEN-SMITH BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+// Author    : Russell J. Funk
+// Email     : funk@umich.edu
+// Web page  : http://www-personal.umich.edu/~funk/index.html
+// Location  : University of Michigan, Ann Arbor, Michigan
+// Date      : December 15, 2012
+// Reference : http://arxiv.org/abs/1212.3559 (pp. 6-8 and pp. 24-25)
+//-----------------------------------------------------------------------------
+
+#ifndef _RESULTS_H
+#define _RESULTS_H
+
+#include <stdint.h>
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+
+#include "dictionary.h"
+#include "edgraph_v1.h"
+
+// a results file is either text, one comma-separated row per line
+//
+//     vertex,time,year,disruptiveness,radicalness,indegree
+//
+// or binary: a fixed-size header followed by groups of rows, each a 64-bit
+// row count n and then the columns of its rows one after the other
+//
+//     n vertex ids (64-bit), n years (32-bit), n disruptiveness values
+//     (64-bit floating point), n radicalness values (same), n in-degrees
+//     (32-bit)
+//
+// for a graph of string ids (see dictionary.h), text files hold the ids and
+// binary files their numbers in the dictionary. the binary format leaves out
+// the vertex time, which the graph has; like
+// snapshots (see snapshot.h), it is written in the byte order of the machine,
+// which the header records
+
+// first bytes of every binary results file, and the current version of the
+// format
+static const char resultsmagic[8] = {'E', 'D', 'G', 'R', 'E', 'S', 'L', 'T'};
+static const uint32_t resultsversion = 1;
+
+// written as a 32-bit integer to record the byte order
+static const uint32_t resultsbyteorder = 0x01020304;
+
+struct ResultsHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteorder;
+    uint32_t columns; // number of columns, 5
+    uint32_t unused;
+    uint64_t rows;    // total number of rows, or 0 if not known
+};
+
+// collects the rows of a panel (see PanelT) in a large buffer that goes out
+// to the results stream, and optionally to an echo stream, only once it is
+// full, rather than flushing the streams row by row
+//
+// worker threads encode their rows into buffers of their own with encode(),
+// which is const and takes no lock; the encoded blocks are then handed to
+// write() by a single thread in output order, which costs a copy per block
+// rather than a lock per row
+class ResultsSink {
+    
+private:
+    
+    // where the rows go, in which format, and where a text copy goes
+    std::ostream &results_;
+    int format_;
+    std::ostream *echo_;
+    
+    // encoded rows not yet written, and the buffer size that triggers a write
+    std::string buffer_;
+    std::size_t capacity_;
+    
+    // binary rows are encoded as records of this size and turned into
+    // columns when written
+    static const std::size_t recordbytes = 32;
+    std::string columns_;
+    
+    // dictionary of the vertex ids, or NULL if they are numbers
+    const IdDictionary *ids_;
+    
+    // rows written so far, and where the header went if binary
+    uint64_t rows_;
+    std::streamoff header_;
+    bool closed_;
+    
+    // write out the buffered rows
+    void drain();
+    
+public:
+    
+    // formats of the results, see above
+    enum Format { TEXT, BINARY };
+    
+    // sink writing to results in format and, if given and the format is
+    // text, also to echo, once capacity bytes of rows have been buffered
+    ResultsSink(std::ostream &results, Format format = TEXT,
+                std::ostream *echo = NULL, std::size_t capacity = 1 << 22);
+    
+    // format of the results
+    Format format() const;
+    
+    // write the vertices of text rows as the ids numbered by ids, or as
+    // numbers if ids is NULL (the default)
+    void dictionary(const IdDictionary *ids);
+    
+    // append one row, encoded in the format of the sink, to rows
+    void encode(std::string &rows, unsigned long vertex, unsigned long time,
+                unsigned long year, const Metrics &m) const;
+    
+    // add rows encoded by encode() to the results
+    void write(const std::string &rows);
+    
+    // number of rows added so far
+    unsigned long rows() const;
+    
+    // write out the buffered rows and flush the streams
+    void flush();
+    
+    // flush and, if binary and the results stream can seek, record the number
+    // of rows in the header; no rows may be added after
+    void close();
+    
+    // closes the sink
+    ~ResultsSink();
+    
+};
+
+#endif
@@ -0,0 +1,565 @@
+//-----------------------------------------------------------------------------
+// File        : server.cpp
+// Description : Answers lookups on a graph loaded once, over a pipe or socket
+//-----------------------------------------------------------------------------
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the University of Michigan nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL RUSSELL J. FUNK OR JASON OWEN-SMITH BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+// Author    : Russell J. Funk
+// Email     : funk@umich.edu
+// Web page  : http://www-personal.umich.edu/~funk/index.html
+// Location  : University of Michigan, Ann Arbor, Michigan
+// Date      : December 15, 2012
+// Reference : http://arxiv.org/abs/1212.3559 (pp. 6-8 and pp. 24-25)
+//-----------------------------------------------------------------------------
+
+#include <errno.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "edgraph_v1.h"
+#include "server.h"
+
+namespace {
+
+// split line into words separated by spaces, tabs or carriage returns; a
+// word in double quotes (doubled inside) may hold any of these
+void words(const std::string &line, std::vector<std::string> &words) {
+    words.clear();
+    std::string::size_type begin = line.find_first_not_of(" \t\r");
+    while (begin != std::string::npos) {
+        std::string::size_type end;
+        if (line[begin] == '"') {
+            words.push_back(std::string());
+            for (end = begin + 1; end < line.size(); end++) {
+                if (line[end] == '"' && (end + 1 == line.size() || line[end + 1] != '"')) {
+                    end++;
+                    break;
+                }
+                if (line[end] == '"') {
+                    end++;
+                }
+                words.back().push_back(line[end]);
+            }
+        }
+        else {
+            end = line.find_first_of(" \t\r", begin);
+            words.push_back(line.substr(begin, end == std::string::npos ?
+                                               std::string::npos : end - begin));
+        }
+        begin = line.find_first_not_of(" \t\r", end);
+    }
+}
+
+// parse an unsigned decimal number; false if word is not one or overflows
+bool number(const std::string &word, unsigned long &value) {
+    if (word.empty() || word.size() > 20 ||
+        word.find_first_not_of("0123456789") != std::string::npos) {
+        return false;
+    }
+    errno = 0;
+    value = strtoul(word.c_str(), NULL, 10);
+    return errno == 0;
+}
+
+// parse a non-negative decimal fraction; false if word is not one
+bool fraction(const std::string &word, double &value) {
+    char *end;
+    errno = 0;
+    value = strtod(word.c_str(), &end);
+    return !word.empty() && *end == '\0' && errno == 0 && value >= 0;
+}
+
+// append an unsigned number or a floating point value, as in results files
+void append(std::string &text, unsigned long value) {
+    char buffer[24];
+    int n = snprintf(buffer, sizeof(buffer), "%lu", value);
+    text.append(buffer, n);
+}
+
+void append(std::string &text, double value) {
+    char buffer[32];
+    int n = snprintf(buffer, sizeof(buffer), "%g", value);
+    text.append(buffer, n);
+}
+
+// append the words of a metrics response
+void append(std::string &text, const Metrics &m) {
+    append(text, m.disrupt);
+    text += ' ';
+    append(text, m.radical);
+    text += ' ';
+    append(text, m.indegree);
+    text += ' ';
+    append(text, m.fonly);
+    text += ' ';
+    append(text, m.both);
+    text += ' ';
+    append(text, m.bonly);
+}
+
+// write all of data to file descriptor fd
+bool writeall(int fd, const std::string &data) {
+    std::string::size_type done = 0;
+    while (done < data.size()) {
+        ssize_t n = write(fd, data.data() + done, data.size() - done);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        done += n;
+    }
+    return true;
+}
+
+}
+
+// server for g with threads workers
+template <typename Graph>
+ServerT<Graph>::ServerT(const Graph &g, const IdDictionary *ids,
+                        unsigned int threads, unsigned long batch)
+    : g_(g), ids_(ids), threads_(threads), batch_(batch), stopping_(false), total_(0),
+      longest_(0) {
+    
+    if (threads_ == 0) {
+        threads_ = std::thread::hardware_concurrency();
+    }
+    if (threads_ == 0) {
+        threads_ = 1;
+    }
+    if (batch_ == 0) {
+        batch_ = 1;
+    }
+    for (unsigned int k = 0; k < buckets; k++) {
+        latencies_[k] = 0;
+    }
+    
+    // the thread answering a batch helps, so one worker fewer is needed
+    for (unsigned int w = 1; w < threads_; w++) {
+        workers_.push_back(std::thread([this]() {
+            std::unique_lock<std::mutex> guard(lock_);
+            for (;;) {
+                work_.wait(guard, [this]() {
+                    return stopping_ || !batches_.empty();
+                });
+                if (stopping_) {
+                    return;
+                }
+                ServerT::help(NULL, guard);
+            }
+        }));
+    }
+}
+
+template <typename Graph>
+ServerT<Graph>::~ServerT() {
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        stopping_ = true;
+    }
+    work_.notify_all();
+    for (unsigned int w = 0; w < workers_.size(); w++) {
+        workers_[w].join();
+    }
+}
+
+// take and answer requests of batch b, or of any batch
+template <typename Graph>
+void ServerT<Graph>::help(Batch *b, std::unique_lock<std::mutex> &guard) {
+    
+    for (;;) {
+        Batch *c = b;
+        if (c == NULL) {
+            if (batches_.empty()) {
+                return;
+            }
+            c = batches_.front();
+        }
+        unsigned long n = c->requests->size();
+        if (c->next == n) {
+            return;
+        }
+        
+        // a batch leaves the queue once its last request is taken, and its
+        // caller waits for every request to be answered before it goes
+        unsigned long k = c->next++;
+        if (c->next == n) {
+            batches_.erase(std::find(batches_.begin(), batches_.end(), c));
+        }
+        guard.unlock();
+        ServerT::respond((*c->requests)[k], c->start, (*c->responses)[k]);
+        guard.lock();
+        if (++c->done == n) {
+            done_.notify_all();
+        }
+    }
+}
+
+// the vertex named by word
+template <typename Graph>
+bool ServerT<Graph>::parse(const std::string &word, unsigned long &v) const {
+    if (ids_ != NULL) {
+        return ids_->find(word, v);
+    }
+    return number(word, v);
+}
+
+// append vertex v to text
+template <typename Graph>
+void ServerT<Graph>::name(std::string &text, unsigned long v) const {
+    if (ids_ != NULL) {
+        ids_->append(text, v);
+    }
+    else {
+        append(text, v);
+    }
+}
+
+// answer request, read at start, into response
+template <typename Graph>
+void ServerT<Graph>::respond(const std::string &request,
+                             std::chrono::steady_clock::time_point start,
+                             std::string &response) {
+    
+    std::vector<std::string> w;
+    words(request, w);
+    
+    // the answer, or what is wrong with the request
+    std::string body;
+    std::string error;
+    unsigned long vertex = 0;
+    unsigned long a = 0;
+    unsigned long b = 0;
+    std::string command = w.empty() ? std::string() : w[0];
+    
+    if ((command == "metrics" || command == "disrupt" || command == "indegree" ||
+         command == "citing") && w.size() == 3) {
+        if (!ServerT::parse(w[1], vertex)) {
+            error = "unknown vertex";
+        }
+        else if (!number(w[2], a)) {
+            error = "bad number";
+        }
+        else if (command == "metrics") {
+            append(body, g_.metrics(vertex, a));
+        }
+        else if (command == "disrupt") {
+            append(body, g_.disrupt(vertex, a));
+        }
+        else if (command == "indegree") {
+            append(body, g_.indegree(vertex, a));
+        }
+        else {
+            std::vector<unsigned long> citing;
+            g_.citing(vertex, a, citing);
+            append(body, (unsigned long)citing.size());
+            for (unsigned long k = 0; k < citing.size(); k++) {
+                body += ' ';
+                ServerT::name(body, citing[k]);
+            }
+        }
+    }
+    else if ((command == "cited" || command == "time") && w.size() == 2) {
+        if (!ServerT::parse(w[1], vertex)) {
+            error = "unknown vertex";
+        }
+        else if (command == "cited") {
+            std::vector<unsigned long> cited;
+            g_.cited(vertex, cited);
+            append(body, (unsigned long)cited.size());
+            for (unsigned long k = 0; k < cited.size(); k++) {
+                body += ' ';
+                ServerT::name(body, cited[k]);
+            }
+        }
+        else {
+            unsigned long time = g_.time(vertex);
+            if (time == Graph::notime) {
+                body = "none";
+            }
+            else {
+                append(body, time);
+            }
+        }
+    }
+    else if (command == "window" && w.size() == 4) {
+        if (!ServerT::parse(w[1], vertex)) {
+            error = "unknown vertex";
+        }
+        else if (!number(w[2], a) || !number(w[3], b)) {
+            error = "bad number";
+        }
+        else {
+            append(body, g_.metrics_window(vertex, a, b));
+        }
+    }
+    else if (command == "approx" && w.size() == 5) {
+        double e;
+        if (!ServerT::parse(w[1], vertex)) {
+            error = "unknown vertex";
+        }
+        else if (!number(w[2], a) || !number(w[3], b) || !fraction(w[4], e)) {
+            error = "bad number";
+        }
+        else {
+            Estimate estimate = g_.metrics_approx(vertex, a, b, e);
+            append(body, estimate.metrics.disrupt);
+            body += ' ';
+            append(body, estimate.low);
+            body += ' ';
+            append(body, estimate.high);
+            body += estimate.approximated ? " 1 " : " 0 ";
+            append(body, estimate.samples);
+        }
+    }
+    else if (command == "stats" && w.size() == 1) {
+        
+        // summary of the requests answered so far, this one not included
+        unsigned long counts[buckets];
+        unsigned long n = 0;
+        for (unsigned int k = 0; k < buckets; k++) {
+            counts[k] = latencies_[k].load();
+            n += counts[k];
+        }
+        unsigned long p50 = 0;
+        unsigned long p99 = 0;
+        unsigned long seen = 0;
+        for (unsigned int k = 0; k < buckets && n > 0; k++) {
+            seen += counts[k];
+            if (p50 == 0 && 2*seen >= n) {
+                p50 = 2UL << k;
+            }
+            if (p99 == 0 && 100*seen >= 99*n) {
+                p99 = 2UL << k;
+            }
+        }
+        body = "requests ";
+        append(body, n);
+        body += " mean ";
+        append(body, n > 0 ? total_.load()/1e3/n : 0.0);
+        body += " p50 ";
+        append(body, p50);
+        body += " p99 ";
+        append(body, p99);
+        body += " max ";
+        append(body, longest_.load()/1e3);
+    }
+    else {
+        error = "unknown request";
+    }
+    
+    // the time from reading the request to answering it
+    unsigned long ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    unsigned int bucket = 0;
+    for (unsigned long us = ns/1000; us > 1 && bucket + 1 < buckets; us >>= 1) {
+        bucket++;
+    }
+    latencies_[bucket].fetch_add(1, std::memory_order_relaxed);
+    total_.fetch_add(ns, std::memory_order_relaxed);
+    unsigned long longest = longest_.load(std::memory_order_relaxed);
+    while (ns > longest &&
+           !longest_.compare_exchange_weak(longest, ns, std::memory_order_relaxed)) {
+    }
+    
+    char us[32];
+    snprintf(us, sizeof(us), "%.1f", ns/1e3);
+    response = error.empty() ? "ok " : "error ";
+    response += us;
+    response += ' ';
+    response += error.empty() ? body : error;
+}
+
+// answer requests read at start into responses, sharing them out among the
+// workers
+template <typename Graph>
+void ServerT<Graph>::answer(const std::vector<std::string> &requests,
+                            std::chrono::steady_clock::time_point start,
+                            std::vector<std::string> &responses) {
+    
+    responses.resize(requests.size());
+    
+    // a lone request is answered straight away
+    if (threads_ == 1 || requests.size() == 1) {
+        for (unsigned long k = 0; k < requests.size(); k++) {
+            ServerT::respond(requests[k], start, responses[k]);
+        }
+        return;
+    }
+    
+    Batch b;
+    b.requests = &requests;
+    b.responses = &responses;
+    b.start = start;
+    b.next = 0;
+    b.done = 0;
+    
+    std::unique_lock<std::mutex> guard(lock_);
+    batches_.push_back(&b);
+    work_.notify_all();
+    ServerT::help(&b, guard);
+    done_.wait(guard, [&]() { return b.done == requests.size(); });
+}
+
+// answer the requests read from in, writing the responses to out
+template <typename Graph>
+bool ServerT<Graph>::serve(int in, int out) {
+    
+    std::vector<char> buffer(1 << 16);
+    std::string pending;
+    std::vector<std::string> requests;
+    std::vector<std::string> responses;
+    std::vector<std::string> w;
+    std::string output;
+    bool quit = false;
+    bool end = false;
+    
+    while (!quit && !end) {
+        ssize_t n = read(in, &buffer[0], buffer.size());
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            return false;
+        }
+        
+        // the last line of the input need not end with a newline
+        if (n == 0) {
+            if (pending.empty()) {
+                break;
+            }
+            pending += '\n';
+            end = true;
+        }
+        
+        // all complete lines read so far are answered together, in batches
+        // of up to batch_ requests
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        pending.append(&buffer[0], n);
+        std::string::size_type begin = 0;
+        std::string::size_type newline;
+        for (;;) {
+            newline = pending.find('\n', begin);
+            if (newline != std::string::npos) {
+                std::string line = pending.substr(begin, newline - begin);
+                begin = newline + 1;
+                words(line, w);
+                if (w.empty()) {
+                    continue;
+                }
+                if (w.size() == 1 && w[0] == "quit") {
+                    quit = true;
+                }
+                else {
+                    requests.push_back(line);
+                }
+            }
+            
+            if (!requests.empty() &&
+                (requests.size() == batch_ || newline == std::string::npos || quit)) {
+                ServerT::answer(requests, start, responses);
+                output.clear();
+                for (unsigned long k = 0; k < responses.size(); k++) {
+                    output += responses[k];
+                    output += '\n';
+                }
+                if (!writeall(out, output)) {
+                    return false;
+                }
+                requests.clear();
+            }
+            if (newline == std::string::npos || quit) {
+                break;
+            }
+        }
+        pending.erase(0, begin);
+    }
+    return true;
+}
+
+// accept connections to a Unix socket at path and serve each in a thread of
+// its own
+template <typename Graph>
+bool ServerT<Graph>::listen(const std::string &path, std::string &message) {
+    
+    // a client that goes away makes writing to it fail rather than the
+    // whole server stop
+    signal(SIGPIPE, SIG_IGN);
+    
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        message = "the socket path '" + path + "' is too long";
+        return false;
+    }
+    strcpy(address.sun_path, path.c_str());
+    
+    int s = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (s < 0) {
+        message = "could not create a socket";
+        return false;
+    }
+    unlink(path.c_str());
+    if (bind(s, (sockaddr *)&address, sizeof(address)) != 0 ||
+        ::listen(s, 64) != 0) {
+        close(s);
+        message = "could not listen on the socket '" + path + "'";
+        return false;
+    }
+    
+    for (;;) {
+        int c = accept(s, NULL, NULL);
+        if (c < 0 && (errno == EINTR || errno == ECONNABORTED)) {
+            continue;
+        }
+        if (c < 0) {
+            close(s);
+            message = "could not accept connections on the socket '" + path + "'";
+            return false;
+        }
+        std::thread([this, c]() {
+            ServerT::serve(c, c);
+            close(c);
+        }).detach();
+    }
+}
+
+// the servers of the graph types compiled into the library
+template class ServerT<EDGraph>;
+template class ServerT<EDGraph32>;
+template class ServerT<CompactEDGraph>;
@@ -0,0 +1,169 @@
+//-----------------------------------------------------------------------------
+// File        : server.h
+// Description : Answers lookups on a graph loaded once, over a pipe or socket
+//-----------------------------------------------------------------------------
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the University of Michigan nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL RUSSELL J. FUNK OR JASON OWEN-SMITH BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+// Author    : Russell J. Funk
+// Email     : funk@umich.edu
+// Web page  : http://www-personal.umich.edu/~funk/index.html
+// Location  : University of Michigan, Ann Arbor, Michigan
+// Date      : December 15, 2012
+// Reference : http://arxiv.org/abs/1212.3559 (pp. 6-8 and pp. 24-25)
+//-----------------------------------------------------------------------------
+
+#ifndef _SERVER_H
+#define _SERVER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "dictionary.h"
+#include "edgraph_v1.h"
+
+// answers lookups on a graph loaded once, so that each takes microseconds
+// rather than the minutes of reading the graph again. a request is a line
+// of words separated by spaces, and gets a line in response:
+//
+//     metrics vertex endtime     ok us disrupt radical indegree fonly both bonly
+//     disrupt vertex endtime     ok us disrupt
+//     indegree vertex endtime    ok us indegree
+//     citing vertex endtime      ok us count vertex...
+//     cited vertex               ok us count vertex...
+//     time vertex                ok us time (or none)
+//     window vertex start end    ok us disrupt radical indegree fonly both bonly
+//     approx vertex endtime threshold error
+//                                ok us disrupt low high approximated samples
+//     stats                      ok us requests n mean us p50 us p99 us max us
+//     quit                       (no response; ends the session)
+//
+// where us is the time in microseconds from reading the request to
+// answering it, and stats summarizes those of all requests so far (p50 and
+// p99 rounded up to a power of two). a request that cannot be parsed gets
+// "error us message", and blank lines are ignored. responses come in the
+// order of the requests; requests that arrive together, e.g. pipelined by a
+// client that does not wait for each response, are answered as a batch
+// shared out among the worker threads, and the connections to a Unix socket
+// are served concurrently, all sharing the same workers. for a graph of
+// string ids (see dictionary.h), vertices are given and listed as their ids,
+// in double quotes if they hold white space or quotes. Graph is one of the
+// graph types of edgraph_v1.h
+template <typename Graph>
+class ServerT {
+    
+private:
+    
+    // graph the lookups are made on, and the dictionary of its vertex ids
+    // if they are strings
+    const Graph &g_;
+    const IdDictionary *ids_;
+    
+    // number of threads answering a batch (the caller's included), and the
+    // most requests per batch
+    unsigned int threads_;
+    unsigned long batch_;
+    
+    // a batch of requests being answered, all of it guarded by lock_: the
+    // next request to be taken and the number answered
+    struct Batch {
+        const std::vector<std::string> *requests;
+        std::vector<std::string> *responses;
+        std::chrono::steady_clock::time_point start;
+        unsigned long next;
+        unsigned long done;
+    };
+    
+    // batches with requests still to be taken, and the workers taking them
+    std::mutex lock_;
+    std::condition_variable work_;
+    std::condition_variable done_;
+    std::deque<Batch *> batches_;
+    bool stopping_;
+    std::vector<std::thread> workers_;
+    
+    // number of requests answered in [2^k, 2^(k + 1)) microseconds (the
+    // first also taking those under a microsecond), their total and longest
+    // time in nanoseconds
+    static const unsigned int buckets = 48;
+    std::atomic<unsigned long> latencies_[buckets];
+    std::atomic<unsigned long> total_;
+    std::atomic<unsigned long> longest_;
+    
+    ServerT(const ServerT &);
+    ServerT &operator=(const ServerT &);
+    
+    // the vertex named by word; false if there is none
+    bool parse(const std::string &word, unsigned long &v) const;
+    
+    // append vertex v to text
+    void name(std::string &text, unsigned long v) const;
+    
+    // answer request, read at start, into response
+    void respond(const std::string &request,
+                 std::chrono::steady_clock::time_point start,
+                 std::string &response);
+    
+    // take and answer requests of batch b (any batch if b is NULL) until
+    // there are none left to take; called with lock_ held by guard
+    void help(Batch *b, std::unique_lock<std::mutex> &guard);
+    
+public:
+    
+    // server for g, with ids the dictionary of its vertex ids or NULL if
+    // they are numbers, with threads workers (0 = one per core) answering up
+    // to batch requests at once
+    explicit ServerT(const Graph &g, const IdDictionary *ids = NULL,
+                     unsigned int threads = 0, unsigned long batch = 1024);
+    ~ServerT();
+    
+    // answer requests read at start into responses, in order, sharing them
+    // out among the workers
+    void answer(const std::vector<std::string> &requests,
+                std::chrono::steady_clock::time_point start,
+                std::vector<std::string> &responses);
+    
+    // answer the requests read from file descriptor in, writing the responses
+    // to file descriptor out, until the end of the input or quit; returns
+    // false if reading or writing fails
+    bool serve(int in, int out);
+    
+    // accept connections to a Unix socket at path (replacing any file there)
+    // and serve each in a thread of its own, with serve(); returns only if
+    // the socket cannot be set up or accepting fails, with the problem in
+    // message
+    bool listen(const std::string &path, std::string &message);
+    
+};
+
+typedef ServerT<EDGraph> Server;
+
+#endif
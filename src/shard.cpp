@@ -0,0 +1,176 @@
+//-----------------------------------------------------------------------------
+// File        : shard.cpp
+// Description : Splits a panel across processes and merges their results
+//-----------------------------------------------------------------------------
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the University of Michigan nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL RUSSELL J. FUNK OR JASON OWEN-SMITH BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+// Author    : Russell J. Funk
+// Email     : funk@umich.edu
+// Web page  : http://www-personal.umich.edu/~funk/index.html
+// Location  : University of Michigan, Ann Arbor, Michigan
+// Date      : December 15, 2012
+// Reference : http://arxiv.org/abs/1212.3559 (pp. 6-8 and pp. 24-25)
+//-----------------------------------------------------------------------------
+
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <ostream>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "results.h"
+#include "shard.h"
+
+// mix the bits of a vertex id (the splitmix64 finalizer), so that shards by
+// hash do not depend on how the ids were assigned
+static uint64_t mix(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+// the vertices of shard k of n
+std::vector<unsigned long> shard(const std::vector<unsigned long> &vertices,
+                                 unsigned long k, unsigned long n,
+                                 ShardMethod method) {
+    
+    std::vector<unsigned long> slice;
+    
+    if (method == SHARD_HASH) {
+        for (std::vector<unsigned long>::const_iterator it1 = vertices.begin();
+             it1 != vertices.end(); ++it1) {
+            if (mix(*it1) % n == k) {
+                slice.push_back(*it1);
+            }
+        }
+    }
+    else {
+        unsigned long begin = vertices.size()/n*k + std::min(k, vertices.size() % n);
+        unsigned long end = begin + vertices.size()/n + (k < vertices.size() % n ? 1 : 0);
+        slice.assign(vertices.begin() + begin, vertices.begin() + end);
+    }
+    return slice;
+}
+
+// the year and vertex of a row of a text results file, or false if the line
+// is not a row
+static bool key(const std::string &line, unsigned long &year, unsigned long &vertex) {
+    
+    const char *field = line.c_str();
+    char *next;
+    vertex = strtoul(field, &next, 10);
+    if (next == field || *next != ',') {
+        return false;
+    }
+    strtoul(next + 1, &next, 10);
+    if (*next != ',') {
+        return false;
+    }
+    field = next + 1;
+    year = strtoul(field, &next, 10);
+    return next != field && *next == ',';
+}
+
+// merge text part files into results
+bool mergeparts(const std::vector<std::string> &parts, std::ostream &results,
+                unsigned long &rows, uint64_t &checksum, std::string &message) {
+    
+    rows = 0;
+    checksum = 0xcbf29ce484222325ULL;
+    
+    std::vector<std::ifstream *> in;
+    for (unsigned long p = 0; p < parts.size(); p++) {
+        in.push_back(new std::ifstream(parts[p].c_str()));
+        if (!in.back()->is_open()) {
+            message = "could not open the file '" + parts[p] + "'";
+        }
+    }
+    
+    // the next row of every part, smallest (year, vertex) on top
+    typedef std::pair<std::pair<unsigned long, unsigned long>, unsigned long> Head;
+    std::priority_queue<Head, std::vector<Head>, std::greater<Head> > heads;
+    std::vector<std::string> lines(parts.size());
+    
+    // read the next row of part p into lines[p]
+    auto next = [&](unsigned long p) {
+        while (std::getline(*in[p], lines[p])) {
+            if (lines[p].empty()) {
+                continue;
+            }
+            unsigned long year;
+            unsigned long vertex;
+            if (!key(lines[p], year, vertex)) {
+                message = "the file '" + parts[p] + "' has a line that is not a row";
+                return;
+            }
+            heads.push(Head(std::make_pair(year, vertex), p));
+            return;
+        }
+    };
+    
+    if (message.empty()) {
+        for (unsigned long p = 0; p < parts.size(); p++) {
+            next(p);
+        }
+    }
+    
+    ResultsSink sink(results);
+    std::string row;
+    std::pair<unsigned long, unsigned long> last;
+    
+    while (message.empty() && !heads.empty()) {
+        Head head = heads.top();
+        heads.pop();
+        if (rows > 0 && head.first == last) {
+            message = "the file '" + parts[head.second] + "' repeats a row of another part";
+            break;
+        }
+        last = head.first;
+        
+        row = lines[head.second];
+        row.push_back('\n');
+        for (std::string::const_iterator it1 = row.begin(); it1 != row.end(); ++it1) {
+            checksum ^= (unsigned char)*it1;
+            checksum *= 0x100000001b3ULL;
+        }
+        sink.write(row);
+        rows++;
+        
+        next(head.second);
+    }
+    sink.close();
+    
+    for (unsigned long p = 0; p < in.size(); p++) {
+        delete in[p];
+    }
+    return message.empty();
+}
@@ -0,0 +1,70 @@
+//-----------------------------------------------------------------------------
+// File        : shard.h
+// Description : Splits a panel across processes and merges their results
+//-----------------------------------------------------------------------------
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the University of Michigan nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL RUSSELL J. FUNK OR JASON OWEN-SMITH BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+// Author    : Russell J. Funk
+// Email     : funk@umich.edu
+// Web page  : http://www-personal.umich.edu/~funk/index.html
+// Location  : University of Michigan, Ann Arbor, Michigan
+// Date      : December 15, 2012
+// Reference : http://arxiv.org/abs/1212.3559 (pp. 6-8 and pp. 24-25)
+//-----------------------------------------------------------------------------
+
+#ifndef _SHARD_H
+#define _SHARD_H
+
+#include <stdint.h>
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// a panel can be computed in shards, e.g. by separate processes that open
+// the same snapshot: shard k of n (k = 0 .. n - 1) computes the rows of its
+// share of the vertices, in a part file of its own, and the parts are then
+// merged into the results file the whole panel would have given
+
+// ways of dealing out the vertices: contiguous ranges of the vertices in the
+// order given, or by a hash of their ids, which spreads hubs and vertices of
+// dense id ranges evenly
+enum ShardMethod { SHARD_RANGE, SHARD_HASH };
+
+// the vertices of shard k of n, in the order given
+std::vector<unsigned long> shard(const std::vector<unsigned long> &vertices,
+                                 unsigned long k, unsigned long n,
+                                 ShardMethod method);
+
+// merge text part files (see ResultsSink), each ordered by year and then
+// vertex id as the panel of vertices() is, into results in that order, and
+// return the number of rows and a 64-bit FNV-1a checksum of the merged
+// file. returns false, with the problem in message, if a part cannot be
+// read, a line is not a row, or a row appears in more than one part
+bool mergeparts(const std::vector<std::string> &parts, std::ostream &results,
+                unsigned long &rows, uint64_t &checksum, std::string &message);
+
+#endif
@@ -0,0 +1,290 @@
+//-----------------------------------------------------------------------------
+// File        : snapshot.cpp
+// Description : Reads and writes binary edgraph snapshots
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012, Russell J. Funk and Jason Owen Smith
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the University of Michigan nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL RUSSELL J. FUNK OR JASON OWEN-SMITH BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+// Author    : Russell J. Funk
+// Email     : funk@umich.edu
+// Web page  : http://www-personal.umich.edu/~funk/index.html
+// Location  : University of Michigan, Ann Arbor, Michigan
+// Date      : December 15, 2012
+// Reference : http://arxiv.org/abs/1212.3559 (pp. 6-8 and pp. 24-25)
+//-----------------------------------------------------------------------------
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "edgraph_v1.h"
+#include "snapshot.h"
+#include "stats.h"
+
+// round up to the section alignment
+static uint64_t align(uint64_t offset) {
+    return (offset + snapshotalign - 1)/snapshotalign*snapshotalign;
+}
+
+// bytes per element of each section, given the widths of the stored types
+static void widths(uint64_t bytes[SNAPSHOT_SECTIONS], uint64_t idbytes,
+                   uint64_t indexbytes, uint64_t timebytes) {
+    bytes[SNAPSHOT_IDS] = idbytes;
+    bytes[SNAPSHOT_TIMES] = timebytes;
+    bytes[SNAPSHOT_CITEDOFFSETS] = idbytes;
+    bytes[SNAPSHOT_CITED] = indexbytes;
+    bytes[SNAPSHOT_CITINGOFFSETS] = idbytes;
+    bytes[SNAPSHOT_CITING] = indexbytes;
+    bytes[SNAPSHOT_CITINGTIMES] = timebytes;
+}
+
+// fill in a header for a snapshot
+uint64_t snapshotheader(SnapshotHeader &header, uint32_t indexbytes,
+                        uint32_t timebytes, uint64_t vertices, uint64_t edges) {
+    
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, snapshotmagic, sizeof(header.magic));
+    header.version = snapshotversion;
+    header.byteorder = snapshotbyteorder;
+    header.idbytes = sizeof(unsigned long);
+    header.indexbytes = indexbytes;
+    header.timebytes = timebytes;
+    header.vertices = vertices;
+    header.edges = edges;
+    
+    uint64_t bytes[SNAPSHOT_SECTIONS];
+    widths(bytes, header.idbytes, header.indexbytes, header.timebytes);
+    
+    uint64_t lengths[SNAPSHOT_SECTIONS] = {
+        vertices, vertices, vertices + 1, edges, vertices + 1, edges, edges
+    };
+    
+    uint64_t offset = align(sizeof(header));
+    for (int k = 0; k < SNAPSHOT_SECTIONS; k++) {
+        header.offsets[k] = offset;
+        offset = align(offset + lengths[k]*bytes[k]);
+    }
+    return offset;
+}
+
+// read the index and time widths from the header of a snapshot
+bool snapshottypes(const std::string &snapshotfile, uint32_t &indexbytes,
+                   uint32_t &timebytes) {
+    
+    std::ifstream in(snapshotfile.c_str(), std::ios_base::in|std::ios_base::binary);
+    
+    SnapshotHeader header;
+    if (!in.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+        memcmp(header.magic, snapshotmagic, sizeof(header.magic)) != 0 ||
+        header.version != snapshotversion ||
+        header.byteorder != snapshotbyteorder) {
+        return false;
+    }
+    
+    indexbytes = header.indexbytes;
+    timebytes = header.timebytes;
+    return true;
+}
+
+// write the graph as a binary snapshot
+template <typename Index, typename Time>
+bool EDGraphT<Index, Time>::save(const std::string &snapshotfile) const {
+    
+    // the sections are the plain arrays
+    if (compressed_) {
+        std::cout << "a compressed graph cannot be saved" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    
+    const char *sections[SNAPSHOT_SECTIONS] = {
+        reinterpret_cast<const char *>(ids_.begin()),
+        reinterpret_cast<const char *>(times_.begin()),
+        reinterpret_cast<const char *>(citedoffsets_.begin()),
+        reinterpret_cast<const char *>(cited_.begin()),
+        reinterpret_cast<const char *>(citingoffsets_.begin()),
+        reinterpret_cast<const char *>(citing_.begin()),
+        reinterpret_cast<const char *>(citingtimes_.begin())
+    };
+    
+    SnapshotHeader header;
+    uint64_t offset = snapshotheader(header, sizeof(Index), sizeof(Time),
+                                     ids_.size(), cited_.size());
+    
+    uint64_t bytes[SNAPSHOT_SECTIONS];
+    widths(bytes, header.idbytes, header.indexbytes, header.timebytes);
+    
+    uint64_t lengths[SNAPSHOT_SECTIONS] = {
+        ids_.size(), times_.size(), citedoffsets_.size(), cited_.size(),
+        citingoffsets_.size(), citing_.size(), citingtimes_.size()
+    };
+    
+    std::ofstream out(snapshotfile.c_str(), std::ios_base::out|std::ios_base::binary);
+    if (!out.is_open()) {
+        return false;
+    }
+    
+    // header and sections, each padded with zeros to the next section
+    static const char padding[snapshotalign] = {0};
+    uint64_t written = 0;
+    
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    written += sizeof(header);
+    for (int k = 0; k < SNAPSHOT_SECTIONS; k++) {
+        out.write(padding, header.offsets[k] - written);
+        out.write(sections[k], lengths[k]*bytes[k]);
+        written = header.offsets[k] + lengths[k]*bytes[k];
+    }
+    out.write(padding, offset - written);
+    
+    out.close();
+    return !out.fail();
+}
+
+// whether offsets of vertices + 1 entries start at 0, never decrease and end
+// at edges, so that every list they delimit lies within its section
+static bool validoffsets(const unsigned long *offsets, uint64_t vertices,
+                         uint64_t edges) {
+    if (offsets[0] != 0 || offsets[vertices] != edges) {
+        return false;
+    }
+    for (uint64_t i = 0; i < vertices; i++) {
+        if (offsets[i + 1] < offsets[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// edgraph opened from a binary snapshot
+template <typename Index, typename Time>
+EDGraphT<Index, Time>::EDGraphT(std::string snapshotfile)
+    : compressed_(false), cache_(NULL), graph_(CiterCache::newgraph()) {
+    
+    EDGRAPH_STATS_TIMER(STATS_SNAPSHOT);
+    
+    if (!snapshot_.open(snapshotfile)) {
+        std::cout << "could not open the file '" << snapshotfile << "'" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    
+    // check that the header describes a snapshot this graph type can use in
+    // place
+    SnapshotHeader header;
+    const char *problem = NULL;
+    
+    if (snapshot_.size() < sizeof(header)) {
+        problem = "too short";
+    }
+    else {
+        memcpy(&header, snapshot_.data(), sizeof(header));
+        if (memcmp(header.magic, snapshotmagic, sizeof(header.magic)) != 0) {
+            problem = "not a snapshot";
+        }
+        else if (header.version != snapshotversion) {
+            problem = "unsupported snapshot version";
+        }
+        else if (header.byteorder != snapshotbyteorder) {
+            problem = "written on a machine with a different byte order";
+        }
+        else if (header.idbytes != sizeof(unsigned long) ||
+                 header.indexbytes != sizeof(Index) ||
+                 header.timebytes != sizeof(Time)) {
+            problem = "written with different id, index or time types";
+        }
+    }
+    
+    // and that every section lies within the file
+    uint64_t lengths[SNAPSHOT_SECTIONS];
+    if (problem == NULL) {
+        lengths[SNAPSHOT_IDS] = header.vertices;
+        lengths[SNAPSHOT_TIMES] = header.vertices;
+        lengths[SNAPSHOT_CITEDOFFSETS] = header.vertices + 1;
+        lengths[SNAPSHOT_CITED] = header.edges;
+        lengths[SNAPSHOT_CITINGOFFSETS] = header.vertices + 1;
+        lengths[SNAPSHOT_CITING] = header.edges;
+        lengths[SNAPSHOT_CITINGTIMES] = header.edges;
+        
+        uint64_t bytes[SNAPSHOT_SECTIONS];
+        widths(bytes, header.idbytes, header.indexbytes, header.timebytes);
+        
+        for (int k = 0; k < SNAPSHOT_SECTIONS; k++) {
+            if (header.offsets[k] % snapshotalign != 0 ||
+                header.offsets[k] > snapshot_.size() ||
+                lengths[k] > (snapshot_.size() - header.offsets[k])/bytes[k]) {
+                problem = "truncated or corrupt";
+            }
+        }
+    }
+    
+    // and that the offsets delimit lists within the edge sections; the
+    // lists themselves are used as they are
+    if (problem == NULL) {
+        const char *base = snapshot_.data();
+        if (!validoffsets(reinterpret_cast<const unsigned long *>(
+                              base + header.offsets[SNAPSHOT_CITEDOFFSETS]),
+                          header.vertices, header.edges) ||
+            !validoffsets(reinterpret_cast<const unsigned long *>(
+                              base + header.offsets[SNAPSHOT_CITINGOFFSETS]),
+                          header.vertices, header.edges)) {
+            problem = "corrupt offsets";
+        }
+    }
+    
+    if (problem != NULL) {
+        std::cout << "could not read the snapshot '" << snapshotfile << "': ";
+        std::cout << problem << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    
+    const char *base = snapshot_.data();
+    ids_.refer(reinterpret_cast<const unsigned long *>(
+                   base + header.offsets[SNAPSHOT_IDS]), lengths[SNAPSHOT_IDS]);
+    times_.refer(reinterpret_cast<const Time *>(
+                     base + header.offsets[SNAPSHOT_TIMES]), lengths[SNAPSHOT_TIMES]);
+    citedoffsets_.refer(reinterpret_cast<const unsigned long *>(
+                            base + header.offsets[SNAPSHOT_CITEDOFFSETS]),
+                        lengths[SNAPSHOT_CITEDOFFSETS]);
+    cited_.refer(reinterpret_cast<const Index *>(
+                     base + header.offsets[SNAPSHOT_CITED]), lengths[SNAPSHOT_CITED]);
+    citingoffsets_.refer(reinterpret_cast<const unsigned long *>(
+                             base + header.offsets[SNAPSHOT_CITINGOFFSETS]),
+                         lengths[SNAPSHOT_CITINGOFFSETS]);
+    citing_.refer(reinterpret_cast<const Index *>(
+                      base + header.offsets[SNAPSHOT_CITING]), lengths[SNAPSHOT_CITING]);
+    citingtimes_.refer(reinterpret_cast<const Time *>(
+                           base + header.offsets[SNAPSHOT_CITINGTIMES]),
+                       lengths[SNAPSHOT_CITINGTIMES]);
+}
+
+// the members above for the configurations compiled into the library
+template bool EDGraphT<unsigned long, unsigned long>::save(const std::string &) const;
+template bool EDGraphT<uint32_t, uint32_t>::save(const std::string &) const;
+template bool EDGraphT<uint32_t, uint16_t>::save(const std::string &) const;
+template EDGraphT<unsigned long, unsigned long>::EDGraphT(std::string);
+template EDGraphT<uint32_t, uint32_t>::EDGraphT(std::string);
+template EDGraphT<uint32_t, uint16_t>::EDGraphT(std::string);
@@ -0,0 +1,103 @@
+//-----------------------------------------------------------------------------
+// File        : snapshot.h
+// Description : Describes the binary snapshot format of an edgraph
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012, Russell J. Funk and Jason Owen Smith
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the University of Michigan nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL RUSSELL J. FUNK OR JASON OWEN-SMITH BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+// Author    : Russell J. Funk
+// Email     : funk@umich.edu
+// Web page  : http://www-personal.umich.edu/~funk/index.html
+// Location  : University of Michigan, Ann Arbor, Michigan
+// Date      : December 15, 2012
+// Reference : http://arxiv.org/abs/1212.3559 (pp. 6-8 and pp. 24-25)
+//-----------------------------------------------------------------------------
+
+#ifndef _SNAPSHOT_H
+#define _SNAPSHOT_H
+
+#include <stdint.h>
+
+#include <string>
+
+// a snapshot is a fixed-size header followed by the arrays of the compressed
+// sparse row graph (see EDGraph), in the order of the sections below, each
+// starting at a multiple of snapshotalign bytes so that they can be used in
+// place once the file is memory-mapped
+//
+// integers are stored in the byte order of the machine that wrote the
+// snapshot; the header records it, along with the width of the stored types,
+// so that a snapshot written on an incompatible machine or by an incompatible
+// version is rejected rather than misread, and so that a snapshot can be
+// opened with the graph type (see EDGraphT) that wrote it
+
+// sections of a snapshot
+enum SnapshotSection {
+    SNAPSHOT_IDS,           // vertex ids, sorted (vertices)
+    SNAPSHOT_TIMES,         // vertex times (vertices)
+    SNAPSHOT_CITEDOFFSETS,  // offsets into cited (vertices + 1)
+    SNAPSHOT_CITED,         // citations made (edges)
+    SNAPSHOT_CITINGOFFSETS, // offsets into citing (vertices + 1)
+    SNAPSHOT_CITING,        // citations received, in time order (edges)
+    SNAPSHOT_CITINGTIMES,   // times of the citations received (edges)
+    SNAPSHOT_SECTIONS
+};
+
+// first bytes of every snapshot, and the current version of the format
+static const char snapshotmagic[8] = {'E', 'D', 'G', 'R', 'A', 'P', 'H', '\0'};
+static const uint32_t snapshotversion = 2;
+
+// written as a 32-bit integer to record the byte order
+static const uint32_t snapshotbyteorder = 0x01020304;
+
+// alignment of the sections in bytes
+static const uint64_t snapshotalign = 64;
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteorder;
+    uint32_t idbytes;    // bytes per vertex id and offset
+    uint32_t indexbytes; // bytes per dense index
+    uint32_t timebytes;  // bytes per time
+    uint32_t unused;
+    uint64_t vertices;
+    uint64_t edges;
+    uint64_t offsets[SNAPSHOT_SECTIONS]; // byte offset of each section
+};
+
+// fill in a header for a snapshot of a graph with the given numbers of
+// vertices and edges and widths of the stored types, including the offsets
+// of the sections, and return the size of the snapshot in bytes
+uint64_t snapshotheader(SnapshotHeader &header, uint32_t indexbytes,
+                        uint32_t timebytes, uint64_t vertices, uint64_t edges);
+
+// read the index and time widths from the header of a snapshot, returning
+// false if the file cannot be read or is not a snapshot of this version
+bool snapshottypes(const std::string &snapshotfile, uint32_t &indexbytes,
+                   uint32_t &timebytes);
+
+#endif
@@ -0,0 +1,278 @@
+//-----------------------------------------------------------------------------
+// File        : stats.cpp
+// Description : Optional counters and timers of the load and query phases
+//-----------------------------------------------------------------------------
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the University of Michigan nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL RUSSELL J. FUNK OR JASON OWEN-SMITH BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+// Author    : Russell J. Funk
+// Email     : funk@umich.edu
+// Web page  : http://www-personal.umich.edu/~funk/index.html
+// Location  : University of Michigan, Ann Arbor, Michigan
+// Date      : December 15, 2012
+// Reference : http://arxiv.org/abs/1212.3559 (pp. 6-8 and pp. 24-25)
+//-----------------------------------------------------------------------------
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#include "stats.h"
+
+namespace {
+
+// names of the counters and phases in reports
+const char *countername[STATS_COUNTERS] = {
+    "bytes_parsed", "pairs_parsed", "neighborhoods", "edges_scanned",
+    "citers_filtered", "citers", "swept"
+};
+const char *phasename[STATS_PHASES] = {
+    "parse", "build", "snapshot", "append", "panel"
+};
+
+// the counts of one thread, or of all threads that have finished
+struct StatsBlock {
+    uint64_t counts[STATS_COUNTERS];
+    uint64_t histogram[statsbuckets];
+    
+    // largest neighborhood and the one that took the most scanning, with
+    // the ids of their focal vertices
+    uint64_t largest;
+    unsigned long largestvertex;
+    uint64_t busiest;
+    unsigned long busiestvertex;
+    
+    StatsBlock() {
+        memset(this, 0, sizeof(*this));
+    }
+    
+    // add the counts of another block
+    void add(const StatsBlock &other) {
+        for (int k = 0; k < STATS_COUNTERS; k++) {
+            counts[k] += other.counts[k];
+        }
+        for (int b = 0; b < statsbuckets; b++) {
+            histogram[b] += other.histogram[b];
+        }
+        if (other.largest > largest) {
+            largest = other.largest;
+            largestvertex = other.largestvertex;
+        }
+        if (other.busiest > busiest) {
+            busiest = other.busiest;
+            busiestvertex = other.busiestvertex;
+        }
+    }
+};
+
+// the blocks of running threads, the sum of those of finished threads, and
+// the phase times, all under one lock that is only taken when a thread
+// starts or ends counting and when a phase ends
+struct StatsRegistry {
+    std::mutex lock;
+    std::vector<StatsBlock *> live;
+    StatsBlock finished;
+    double seconds[STATS_PHASES];
+    
+    StatsRegistry() {
+        std::fill(seconds, seconds + STATS_PHASES, 0.0);
+    }
+};
+
+StatsRegistry &registry() {
+    static StatsRegistry registry;
+    return registry;
+}
+
+#ifdef EDGRAPH_STATS
+
+// the block of the calling thread, registered for its lifetime
+struct LocalStats {
+    StatsBlock block;
+    
+    LocalStats() {
+        std::lock_guard<std::mutex> guard(registry().lock);
+        registry().live.push_back(&block);
+    }
+    
+    ~LocalStats() {
+        std::lock_guard<std::mutex> guard(registry().lock);
+        registry().finished.add(block);
+        registry().live.erase(std::find(registry().live.begin(),
+                                        registry().live.end(), &block));
+    }
+};
+
+StatsBlock &localstats() {
+    static thread_local LocalStats stats;
+    return stats.block;
+}
+
+#endif
+
+// the sum of all blocks, and the phase times
+void collect(StatsBlock &total, double seconds[STATS_PHASES]) {
+    std::lock_guard<std::mutex> guard(registry().lock);
+    total = registry().finished;
+    for (unsigned long k = 0; k < registry().live.size(); k++) {
+        total.add(*registry().live[k]);
+    }
+    std::copy(registry().seconds, registry().seconds + STATS_PHASES, seconds);
+}
+
+// peak resident memory of the process in kilobytes
+unsigned long peakrss() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+    return usage.ru_maxrss;
+}
+
+}
+
+#ifdef EDGRAPH_STATS
+
+// add n to a counter
+void statsadd(StatsCounter counter, uint64_t n) {
+    localstats().counts[counter] += n;
+}
+
+// record a gathered neighborhood
+void statsneighborhood(unsigned long vertex, uint64_t size, uint64_t scanned) {
+    
+    StatsBlock &block = localstats();
+    
+    int bucket = 0;
+    while (bucket + 1 < statsbuckets && (size >> bucket) != 0) {
+        bucket++;
+    }
+    block.histogram[bucket]++;
+    block.counts[STATS_NEIGHBORHOODS]++;
+    block.counts[STATS_CITERS] += size;
+    
+    if (size > block.largest) {
+        block.largest = size;
+        block.largestvertex = vertex;
+    }
+    if (scanned > block.busiest) {
+        block.busiest = scanned;
+        block.busiestvertex = vertex;
+    }
+}
+
+// add to the wall time of a phase
+void statstime(StatsPhase phase, double seconds) {
+    std::lock_guard<std::mutex> guard(registry().lock);
+    registry().seconds[phase] += seconds;
+}
+
+#endif
+
+// whether the counters are compiled in
+bool statsenabled() {
+#ifdef EDGRAPH_STATS
+    return true;
+#else
+    return false;
+#endif
+}
+
+// write the counters as text
+void statsreport(std::ostream &out) {
+    
+    out << "peak resident memory: " << peakrss() << " kB" << std::endl;
+    
+    if (!statsenabled()) {
+        out << "no other statistics: compile with -DEDGRAPH_STATS" << std::endl;
+        return;
+    }
+    
+    StatsBlock total;
+    double seconds[STATS_PHASES];
+    collect(total, seconds);
+    
+    for (int k = 0; k < STATS_PHASES; k++) {
+        out << phasename[k] << ": " << seconds[k] << " s" << std::endl;
+    }
+    for (int k = 0; k < STATS_COUNTERS; k++) {
+        out << countername[k] << ": " << total.counts[k] << std::endl;
+    }
+    if (total.counts[STATS_NEIGHBORHOODS] > 0) {
+        out << "largest neighborhood: " << total.largest;
+        out << " (vertex " << total.largestvertex << ")" << std::endl;
+        out << "most citations scanned: " << total.busiest;
+        out << " (vertex " << total.busiestvertex << ")" << std::endl;
+        out << "neighborhood sizes:" << std::endl;
+        for (int b = 0; b < statsbuckets; b++) {
+            if (total.histogram[b] > 0) {
+                out << "  " << (b == 0 ? 0 : 1UL << (b - 1)) << "..";
+                out << (b == 0 ? 0 : (1UL << b) - 1) << ": " << total.histogram[b] << std::endl;
+            }
+        }
+    }
+}
+
+// write the counters as JSON
+void statsjson(std::ostream &out) {
+    
+    out << "{\n  \"enabled\": " << (statsenabled() ? "true" : "false");
+    out << ",\n  \"peak_rss_kb\": " << peakrss();
+    
+    if (statsenabled()) {
+        StatsBlock total;
+        double seconds[STATS_PHASES];
+        collect(total, seconds);
+        
+        out << ",\n  \"seconds\": {";
+        for (int k = 0; k < STATS_PHASES; k++) {
+            out << (k > 0 ? ", " : "") << "\"" << phasename[k] << "\": " << seconds[k];
+        }
+        out << "},\n  \"counts\": {";
+        for (int k = 0; k < STATS_COUNTERS; k++) {
+            out << (k > 0 ? ", " : "") << "\"" << countername[k] << "\": " << total.counts[k];
+        }
+        out << "},\n  \"largest_neighborhood\": {\"vertex\": " << total.largestvertex;
+        out << ", \"size\": " << total.largest << "}";
+        out << ",\n  \"most_scanned\": {\"vertex\": " << total.busiestvertex;
+        out << ", \"edges\": " << total.busiest << "}";
+        
+        // bucket b holds sizes below 2^b, see statsbuckets
+        out << ",\n  \"neighborhood_size_histogram\": [";
+        int last = statsbuckets - 1;
+        while (last > 0 && total.histogram[last] == 0) {
+            last--;
+        }
+        for (int b = 0; b <= last; b++) {
+            out << (b > 0 ? ", " : "") << total.histogram[b];
+        }
+        out << "]";
+    }
+    out << "\n}" << std::endl;
+}
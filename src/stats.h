@@ -0,0 +1,134 @@
+//-----------------------------------------------------------------------------
+// File        : stats.h
+// Description : Optional counters and timers of the load and query phases
+//-----------------------------------------------------------------------------
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the University of Michigan nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL RUSSELL J. FUNK OR JASON OWEN-SMITH BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+// Author    : Russell J. Funk
+// Email     : funk@umich.edu
+// Web page  : http://www-personal.umich.edu/~funk/index.html
+// Location  : University of Michigan, Ann Arbor, Michigan
+// Date      : December 15, 2012
+// Reference : http://arxiv.org/abs/1212.3559 (pp. 6-8 and pp. 24-25)
+//-----------------------------------------------------------------------------
+
+#ifndef _STATS_H
+#define _STATS_H
+
+#include <stdint.h>
+
+#include <chrono>
+#include <iosfwd>
+
+// counters and timers of where a run spends its time, compiled in only when
+// every source file is compiled with EDGRAPH_STATS defined; otherwise the
+// macros below expand to nothing and the reports only say so
+//
+// counts are kept per thread, with no atomics or locks on the way, and
+// summed when a report is written, which should be once the worker threads
+// have finished
+
+// counters
+enum StatsCounter {
+    STATS_BYTESPARSED,    // bytes of csv files parsed
+    STATS_PAIRSPARSED,    // pairs read from csv files
+    STATS_NEIGHBORHOODS,  // neighborhoods gathered, one per metrics() query
+                          // or per vertex of a series
+    STATS_EDGESSCANNED,   // citations scanned while gathering or sweeping
+    STATS_CITERSFILTERED, // citations left out by time without being scanned
+    STATS_CITERS,         // vertices in the neighborhoods gathered
+    STATS_SWEPT,          // citing vertices swept
+    STATS_COUNTERS
+};
+
+// timed phases; appending includes rebuilding the graph
+enum StatsPhase {
+    STATS_PARSE,    // reading csv files
+    STATS_BUILD,    // building the graph from them
+    STATS_SNAPSHOT, // opening a snapshot
+    STATS_APPEND,   // appending vertices and edges
+    STATS_PANEL,    // computing and writing the panel
+    STATS_PHASES
+};
+
+// neighborhood sizes are counted in power of two buckets: bucket 0 holds
+// empty neighborhoods and bucket b sizes from 2^(b - 1) to 2^b - 1
+static const int statsbuckets = 40;
+
+#ifdef EDGRAPH_STATS
+
+// add n to a counter
+void statsadd(StatsCounter counter, uint64_t n);
+
+// record a gathered neighborhood of size vertices, found by scanning
+// scanned citations, of the focal vertex with the given id
+void statsneighborhood(unsigned long vertex, uint64_t size, uint64_t scanned);
+
+// add to the wall time of a phase
+void statstime(StatsPhase phase, double seconds);
+
+// adds the wall time from its construction to its destruction to a phase
+class StatsTimer {
+    
+private:
+    
+    StatsPhase phase_;
+    std::chrono::steady_clock::time_point start_;
+    
+public:
+    
+    explicit StatsTimer(StatsPhase phase)
+        : phase_(phase), start_(std::chrono::steady_clock::now()) {}
+    
+    ~StatsTimer() {
+        statstime(phase_, std::chrono::duration<double>(
+                              std::chrono::steady_clock::now() - start_).count());
+    }
+    
+};
+
+#define EDGRAPH_STATS_ADD(counter, n) statsadd(counter, n)
+#define EDGRAPH_STATS_NEIGHBORHOOD(vertex, size, scanned) \
+    statsneighborhood(vertex, size, scanned)
+#define EDGRAPH_STATS_TIMER(phase) StatsTimer statstimer(phase)
+
+#else
+
+#define EDGRAPH_STATS_ADD(counter, n) ((void)0)
+#define EDGRAPH_STATS_NEIGHBORHOOD(vertex, size, scanned) ((void)0)
+#define EDGRAPH_STATS_TIMER(phase) ((void)0)
+
+#endif
+
+// whether the counters are compiled in
+bool statsenabled();
+
+// write the counters, timers, neighborhood size histogram and peak resident
+// memory as text or as JSON
+void statsreport(std::ostream &out);
+void statsjson(std::ostream &out);
+
+#endif
@@ -0,0 +1,128 @@
+//-----------------------------------------------------------------------------
+// File        : test_approx.cpp
+// Description : Test of the sample sizes and intervals of metrics_approx()
+//-----------------------------------------------------------------------------
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the University of Michigan nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL RUSSELL J. FUNK OR JASON OWEN-SMITH BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+// Author    : Russell J. Funk
+// Email     : funk@umich.edu
+// Web page  : http://www-personal.umich.edu/~funk/index.html
+// Location  : University of Michigan, Ann Arbor, Michigan
+// Date      : December 15, 2012
+// Reference : http://arxiv.org/abs/1212.3559 (pp. 6-8 and pp. 24-25)
+//-----------------------------------------------------------------------------
+
+// to compile and use
+
+// g++ -std=c++11 -O2 -pthread -I../src -I../bench test_approx.cpp
+//     $(ls ../src/*.cpp | grep -v main.cpp) -o test_approx
+
+// ./test_approx
+
+// estimates the metrics of every vertex of a synthetic graph with heavy hubs
+// (see citationgraph.h) with a high threshold and a tight error and with a
+// low threshold and a loose error,
+// and checks that every estimate rests on at least 512 sampled citations,
+// that the metrics not approximated are the exact ones, and that the 95%
+// intervals hold the exact disruptiveness for at least 90% of the vertices.
+// prints the failures and exits with a failure status if there are any
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "citationgraph.h"
+#include "edgraph_v1.h"
+
+int main() {
+    
+    CitationGraphParameters parameters;
+    parameters.vertices = 20000;
+    parameters.skew = 0.9;
+    CitationGraph graph;
+    generate(parameters, graph);
+    EDGraph g(graph.vertices, graph.edges);
+    
+    const unsigned long endtime = 2010;
+    const unsigned long thresholds[] = { 2000, 100 };
+    const double errors[] = { 0.01, 1.0 };
+    
+    unsigned long failures = 0;
+    for (unsigned long e = 0; e < sizeof(errors)/sizeof(errors[0]); e++) {
+        
+        unsigned long threshold = thresholds[e];
+        
+        unsigned long approximated = 0;
+        unsigned long covered = 0;
+        for (unsigned long k = 0; k < graph.vertices.size(); k++) {
+            
+            unsigned long vertex = graph.vertices[k].first;
+            Metrics m = g.metrics(vertex, endtime);
+            Estimate estimate = g.metrics_approx(vertex, endtime, threshold, errors[e]);
+            
+            if (!estimate.approximated) {
+                const Metrics &a = estimate.metrics;
+                if (a.fonly != m.fonly || a.both != m.both || a.bonly != m.bonly ||
+                    a.indegree != m.indegree || estimate.samples != 0) {
+                    if (failures < 10) {
+                        std::cout << "error " << errors[e] << ", vertex " << vertex;
+                        std::cout << ": not approximated, but not exact" << std::endl;
+                    }
+                    failures++;
+                }
+                continue;
+            }
+            
+            approximated++;
+            if (estimate.samples < 512) {
+                if (failures < 10) {
+                    std::cout << "error " << errors[e] << ", vertex " << vertex;
+                    std::cout << ": estimated from " << estimate.samples;
+                    std::cout << " citations" << std::endl;
+                }
+                failures++;
+            }
+            if (std::isnan(m.disrupt) ||
+                (estimate.low <= m.disrupt + 1e-9 && m.disrupt <= estimate.high + 1e-9)) {
+                covered++;
+            }
+        }
+        
+        std::cout << "error " << errors[e] << ": " << approximated << " vertices";
+        std::cout << " approximated, " << covered << " within their intervals";
+        std::cout << std::endl;
+        if (approximated == 0 || covered < 0.9*approximated) {
+            failures++;
+        }
+    }
+    
+    if (failures > 0) {
+        exit(EXIT_FAILURE);
+    }
+    std::cout << "ok" << std::endl;
+    return 0;
+}
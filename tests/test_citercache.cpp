@@ -0,0 +1,246 @@
+//-----------------------------------------------------------------------------
+// File        : test_citercache.cpp
+// Description : Test of a citer cache shared by several graphs
+//-----------------------------------------------------------------------------
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the University of Michigan nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL RUSSELL J. FUNK OR JASON OWEN-SMITH BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+// Author    : Russell J. Funk
+// Email     : funk@umich.edu
+// Web page  : http://www-personal.umich.edu/~funk/index.html
+// Location  : University of Michigan, Ann Arbor, Michigan
+// Date      : December 15, 2012
+// Reference : http://arxiv.org/abs/1212.3559 (pp. 6-8 and pp. 24-25)
+//-----------------------------------------------------------------------------
+
+// to compile and use
+
+// g++ -std=c++11 -O2 -pthread -I../src -I../bench test_citercache.cpp
+//     $(ls ../src/*.cpp | grep -v main.cpp) -o test_citercache
+
+// ./test_citercache
+
+// attaches two different synthetic graphs, whose vertices and citations
+// line up but come from different citers, to one cache of hub citers and
+// checks that the metrics of every vertex of each at several end times,
+// queried alternately, are those computed without a cache; then appends to
+// one of the graphs and checks both again. also checks the bytes taken by
+// the entry of a single hub, cited once or twice by each of its citers,
+// which only a bit set and, for repeated citations, their counts make up.
+// prints the mismatches and exits with a failure status if there are any
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "citationgraph.h"
+#include "edgraph_v1.h"
+
+// end times at which the metrics are compared
+static const unsigned long endtimes[] = { 1990, 2000, 2010 };
+static const unsigned long nendtimes = sizeof(endtimes)/sizeof(endtimes[0]);
+
+// the counts of every vertex of graph at every end time, in vertex order
+static void metrics(const EDGraph &g, const CitationGraph &graph,
+                    std::vector<Metrics> &results) {
+    results.clear();
+    for (unsigned long k = 0; k < graph.vertices.size(); k++) {
+        for (unsigned long t = 0; t < nendtimes; t++) {
+            results.push_back(g.metrics(graph.vertices[k].first, endtimes[t]));
+        }
+    }
+}
+
+// whether two sets of metrics have the same counts
+static bool same(const Metrics &a, const Metrics &b) {
+    return a.fonly == b.fonly && a.both == b.both && a.bonly == b.bonly &&
+           a.indegree == b.indegree;
+}
+
+// compare the metrics of both graphs sharing cache, queried vertex by vertex
+// in turn, with their metrics without a cache; returns the mismatches
+static unsigned long compare(EDGraph &a, const CitationGraph &agraph, EDGraph &b,
+                             const CitationGraph &bgraph, EDGraph::CiterCache &cache,
+                             const std::string &stage) {
+    
+    std::vector<Metrics> aexpected;
+    std::vector<Metrics> bexpected;
+    a.cache(NULL);
+    b.cache(NULL);
+    metrics(a, agraph, aexpected);
+    metrics(b, bgraph, bexpected);
+    
+    a.cache(&cache);
+    b.cache(&cache);
+    
+    unsigned long mismatches = 0;
+    unsigned long n = std::max(agraph.vertices.size(), bgraph.vertices.size());
+    for (unsigned long k = 0; k < n; k++) {
+        for (unsigned long t = 0; t < nendtimes; t++) {
+            for (int side = 0; side < 2; side++) {
+                EDGraph &g = side == 0 ? a : b;
+                const CitationGraph &graph = side == 0 ? agraph : bgraph;
+                const std::vector<Metrics> &expected = side == 0 ? aexpected : bexpected;
+                if (k >= graph.vertices.size()) {
+                    continue;
+                }
+                Metrics found = g.metrics(graph.vertices[k].first, endtimes[t]);
+                if (!same(found, expected[k*nendtimes + t])) {
+                    if (mismatches < 10) {
+                        std::cout << stage << ": graph " << (side == 0 ? "a" : "b");
+                        std::cout << ", vertex " << graph.vertices[k].first;
+                        std::cout << ", end time " << endtimes[t] << " differs";
+                        std::cout << " with the cache" << std::endl;
+                    }
+                    mismatches++;
+                }
+            }
+        }
+    }
+    
+    CiterCacheStats stats = cache.stats();
+    std::cout << stage << ": " << stats.hits << " hits, " << stats.misses;
+    std::cout << " misses, " << mismatches << " mismatches" << std::endl;
+    return mismatches;
+}
+
+// cache the citers of one hub, cited by every other vertex, each citing it
+// repeats + 1 times, through the metrics of its first citer, and compare
+// those metrics with the ones without a cache and the bytes of the entry
+// with those of a bit set and, if there are repeats, one count per citation
+// and one more; returns the mismatches
+static unsigned long hub(unsigned long repeats) {
+    
+    const unsigned long n = 4096;
+    std::vector<std::pair<unsigned long, unsigned long> > vertices;
+    std::vector<std::pair<unsigned long, unsigned long> > edges;
+    vertices.push_back(std::make_pair(1UL, 1990UL));
+    for (unsigned long k = 2; k <= n; k++) {
+        vertices.push_back(std::make_pair(k, 2000 + k % 10));
+        for (unsigned long r = 0; r <= repeats; r++) {
+            edges.push_back(std::make_pair(k, 1UL));
+        }
+    }
+    EDGraph g(vertices, edges);
+    
+    Metrics expected = g.metrics(2, 2010);
+    EDGraph::CiterCache cache(64UL << 20, 4);
+    g.cache(&cache);
+    Metrics found = g.metrics(2, 2010);
+    
+    unsigned long citations = (n - 1)*(repeats + 1);
+    unsigned long bytes = sizeof(EDGraph::CiterCache::Entry) +
+                          (n + 63)/64*sizeof(uint64_t);
+    if (repeats > 0) {
+        bytes += (citations + 1)*sizeof(uint32_t);
+    }
+    
+    CiterCacheStats stats = cache.stats();
+    std::cout << "hub cited " << repeats + 1 << " times by each citer: ";
+    std::cout << stats.entries << " entries of " << stats.bytes << " bytes" << std::endl;
+    
+    unsigned long mismatches = 0;
+    if (!same(found, expected)) {
+        std::cout << "hub: the metrics differ with the cache" << std::endl;
+        mismatches++;
+    }
+    if (stats.entries != 1 || stats.bytes != bytes) {
+        std::cout << "hub: expected 1 entry of " << bytes << " bytes" << std::endl;
+        mismatches++;
+    }
+    return mismatches;
+}
+
+int main() {
+    
+    // a graph with heavy hubs, and a second one with the same citations
+    // made by other vertices of the same year, so that every vertex has as
+    // many citations in every year in both and its citations end at the
+    // same offsets, but from other citers; the second graph also has more
+    // vertices, which cite nothing and come last, so that bit sets cached
+    // for the first would be too short for it
+    CitationGraphParameters parameters;
+    parameters.vertices = 20000;
+    parameters.skew = 0.9;
+    CitationGraph agraph;
+    generate(parameters, agraph);
+    
+    CitationGraph bgraph;
+    bgraph.vertices = agraph.vertices;
+    unsigned long n = agraph.vertices.size();
+    std::vector<unsigned long> other(n);
+    for (unsigned long begin = 0, end = 0; begin < n; begin = end) {
+        while (end < n && agraph.vertices[end].second == agraph.vertices[begin].second) {
+            end++;
+        }
+        for (unsigned long k = begin; k < end; k++) {
+            other[k] = agraph.vertices[k + 1 < end ? k + 1 : begin].first;
+        }
+    }
+    for (unsigned long e = 0; e < agraph.edges.size(); e++) {
+        unsigned long citing = agraph.edges[e].first - citationgraphfirstid;
+        bgraph.edges.push_back(std::make_pair(other[citing],
+                                              agraph.edges[e].second));
+    }
+    for (unsigned long k = 0; k < n/4; k++) {
+        bgraph.vertices.push_back(std::make_pair(citationgraphfirstid + n + k,
+                                                 parameters.lastyear));
+    }
+    
+    EDGraph a(agraph.vertices, agraph.edges);
+    EDGraph b(bgraph.vertices, bgraph.edges);
+    
+    // a low threshold, so that most predecessors go through the cache
+    EDGraph::CiterCache cache(64UL << 20, 4);
+    
+    unsigned long mismatches = compare(a, agraph, b, bgraph, cache, "shared");
+    
+    // a new vertex citing the first vertices of a changes their citers
+    std::vector<std::pair<unsigned long, unsigned long> > vertices;
+    std::vector<std::pair<unsigned long, unsigned long> > edges;
+    unsigned long id = agraph.vertices.back().first + 1;
+    vertices.push_back(std::make_pair(id, 1985UL));
+    for (unsigned long k = 0; k < 16; k++) {
+        edges.push_back(std::make_pair(id, agraph.vertices[k].first));
+    }
+    std::vector<unsigned long> affected;
+    a.append(vertices, edges, affected);
+    agraph.vertices.insert(agraph.vertices.end(), vertices.begin(), vertices.end());
+    agraph.edges.insert(agraph.edges.end(), edges.begin(), edges.end());
+    
+    mismatches += compare(a, agraph, b, bgraph, cache, "appended");
+    
+    mismatches += hub(0);
+    mismatches += hub(1);
+    
+    if (mismatches > 0) {
+        exit(EXIT_FAILURE);
+    }
+    std::cout << "ok" << std::endl;
+    return 0;
+}
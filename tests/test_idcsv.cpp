@@ -0,0 +1,167 @@
+//-----------------------------------------------------------------------------
+// File        : test_idcsv.cpp
+// Description : Test of header lines in csv files with string ids
+//-----------------------------------------------------------------------------
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the University of Michigan nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL RUSSELL J. FUNK OR JASON OWEN-SMITH BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+// Author    : Russell J. Funk
+// Email     : funk@umich.edu
+// Web page  : http://www-personal.umich.edu/~funk/index.html
+// Location  : University of Michigan, Ann Arbor, Michigan
+// Date      : December 15, 2012
+// Reference : http://arxiv.org/abs/1212.3559 (pp. 6-8 and pp. 24-25)
+//-----------------------------------------------------------------------------
+
+// to compile and use
+
+// g++ -std=c++11 -O2 -pthread -I../src test_idcsv.cpp
+//     $(ls ../src/*.cpp | grep -v main.cpp) -o test_idcsv
+
+// ./test_idcsv [directory]
+
+// reads small vertex and edge files with string ids (see readidcsv), with a
+// header line in both, either or neither of them, and checks that every
+// edge and no header is read, and that a malformed first line of the vertex
+// file is reported rather than taken for a header. the files are written to
+// directory (by default the current one) and removed afterwards. prints the
+// failures and exits with a failure status if there are any
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "dictionary.h"
+#include "edgraph_v1.h"
+
+// vertices of every case, in which B and C cite A
+static const char *vertexlines = "A,2000\nB,2005\nC,2006\n";
+static const char *edgelines = "B,A\nC,A\n";
+
+// write text to file
+static void write(const std::string &file, const std::string &text) {
+    std::ofstream out(file.c_str(), std::ios_base::out|std::ios_base::binary);
+    out << text;
+}
+
+// read the files with the given first lines ("" for none) and check that
+// they give the three vertices and both edges, A being cited twice by 2010;
+// returns the failures
+static unsigned long check(const std::string &directory, const std::string &name,
+                           const std::string &vertexheader,
+                           const std::string &edgeheader) {
+    
+    std::string vertexfile = directory + "/test_idcsv_vertices.csv";
+    std::string edgefile = directory + "/test_idcsv_edges.csv";
+    write(vertexfile, vertexheader + vertexlines);
+    write(edgefile, edgeheader + edgelines);
+    
+    IdDictionary dictionary;
+    std::vector<std::pair<unsigned long, unsigned long> > vertices;
+    std::vector<std::pair<unsigned long, unsigned long> > edges;
+    std::string file;
+    std::vector<CSVError> errors;
+    unsigned long nerrors;
+    bool read = readidcsv(vertexfile, edgefile, dictionary, vertices, edges, file,
+                          errors, nerrors);
+    std::remove(vertexfile.c_str());
+    std::remove(edgefile.c_str());
+    
+    unsigned long failures = 0;
+    if (!read) {
+        std::cout << name << ": not read";
+        if (!errors.empty()) {
+            std::cout << " (" << errors[0].line << ": " << errors[0].message << ")";
+        }
+        std::cout << std::endl;
+        return 1;
+    }
+    if (dictionary.size() != 3 || vertices.size() != 3 || edges.size() != 2) {
+        std::cout << name << ": " << dictionary.size() << " ids, " << vertices.size();
+        std::cout << " vertices and " << edges.size() << " edges rather than 3, 3";
+        std::cout << " and 2" << std::endl;
+        failures++;
+    }
+    
+    unsigned long a;
+    if (!dictionary.find("A", a)) {
+        std::cout << name << ": A is missing" << std::endl;
+        return failures + 1;
+    }
+    EDGraph g(vertices, edges);
+    unsigned long indegree = g.metrics(a, 2010).indegree;
+    if (indegree != 2) {
+        std::cout << name << ": A is cited " << indegree << " times rather than 2";
+        std::cout << std::endl;
+        failures++;
+    }
+    return failures;
+}
+
+int main(int argc, char *argv[]) {
+    
+    std::string directory = argc > 1 ? argv[1] : ".";
+    
+    unsigned long failures = 0;
+    failures += check(directory, "no headers", "", "");
+    failures += check(directory, "both headers", "id,year\n", "citing,cited\n");
+    failures += check(directory, "vertex header only", "id,year\n", "");
+    failures += check(directory, "edge header only", "", "citing,cited\n");
+    
+    // a first line that is malformed rather than a header is an error
+    const char *malformed[] = { "\"A,2000\n", "A 2000\n", "A,\n" };
+    for (unsigned long k = 0; k < sizeof(malformed)/sizeof(malformed[0]); k++) {
+        std::string vertexfile = directory + "/test_idcsv_vertices.csv";
+        std::string edgefile = directory + "/test_idcsv_edges.csv";
+        write(vertexfile, std::string(malformed[k]) + vertexlines);
+        write(edgefile, edgelines);
+        
+        IdDictionary dictionary;
+        std::vector<std::pair<unsigned long, unsigned long> > vertices;
+        std::vector<std::pair<unsigned long, unsigned long> > edges;
+        std::string file;
+        std::vector<CSVError> errors;
+        unsigned long nerrors;
+        bool read = readidcsv(vertexfile, edgefile, dictionary, vertices, edges, file,
+                              errors, nerrors);
+        std::remove(vertexfile.c_str());
+        std::remove(edgefile.c_str());
+        
+        if (read || errors.empty() || errors[0].line != 1) {
+            std::cout << "malformed first line " << k << ": not reported" << std::endl;
+            failures++;
+        }
+    }
+    
+    if (failures > 0) {
+        exit(EXIT_FAILURE);
+    }
+    std::cout << "ok" << std::endl;
+    return 0;
+}